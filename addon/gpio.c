@@ -12,6 +12,14 @@
 #include <unistd.h>
 #include <errno.h>
 #include <time.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <sched.h>
 
 // La version de libgpiod est détectée par binding.gyp et passée comme define
 // LIBGPIOD_V2 ou LIBGPIOD_V1
@@ -23,8 +31,96 @@
   #error "Cannot detect libgpiod version. Please ensure detect-gpiod-version.sh is executable."
 #endif
 
-// Structure pour stocker les lignes GPIO ouvertes
+// Nombre maximum d'événements lus par réveil du thread de monitoring
+#define GPIO_EVENT_BATCH 16
+
+// Mesure d'impulsion (capteurs à temps de vol): durée max du déclenchement
+// et codes de retour en plus de la largeur mesurée
+#define PULSE_MAX_US 1000
+#define PULSE_TIMEOUT -1
+#define PULSE_ERROR -2
+
+// Profils de mouvement PWM et fraction de la durée en accélération (trapèze)
+#define PWM_PROFILE_LINEAR 0
+#define PWM_PROFILE_TRAPEZOIDAL 1
+#define PWM_PROFILE_SCURVE 2
+#define PWM_TRAPEZOID_RAMP 0.25
+#define PWM_RATE_MAX 1000
+
+// Enregistrement binaire des événements: en-tête puis enregistrements de 16 octets
+#define RECORD_MAGIC "RIOREC"
+#define RECORD_VERSION 1
+#define RECORD_CHUNK 65536      // enregistrements ajoutés à chaque extension du fichier
+#define REPLAY_INFLIGHT_MAX 1024 // événements rejoués en attente du thread JavaScript
+
+// Requêtes multi-lignes (moteur pas à pas, ...)
+#define BULK_LINES_MAX 32
+
+// Moteur pas à pas: index des lignes dans la requête, largeur de l'impulsion STEP,
+// délai entre DIR et le premier pas, fin d'attente en attente active
+#define STEPPER_STEP 0
+#define STEPPER_DIR 1
+#define STEPPER_ENABLE 2
+#define STEPPER_PULSE_NS 2000
+#define STEPPER_DIR_SETUP_NS 5000
+#define STEPPER_SPIN_NS 100000 // attente active au plus avant un pas
+#define STEPPER_SPIN_SHARE 10  // et au plus 1/10 de la période du pas
+#define STEPPER_SPEED_MAX 50000 // pas/s
+#define STEPPER_STOP_SOFT 1
+#define STEPPER_STOP_HARD 2
+#define STEPPER_PRIORITY 50
+
+// Échantillonneur: fréquence max (Hz), fenêtre max du filtre (échantillons),
+// taille max de la file des échantillons bruts
+#define SAMPLER_RATE_MAX 50000
+#define SAMPLER_WINDOW_MAX 255
+#define SAMPLER_CAPACITY_MAX 1048576
+#define SAMPLER_PRIORITY 50
+
+// Clavier matriciel: lignes max par côté, stabilisation des colonnes après
+// activation d'une rangée, période min de balayage, balayages max du filtre
+#define KEYPAD_LINES_MAX 16
+#define KEYPAD_SETTLE_NS 10000
+#define KEYPAD_INTERVAL_MIN_US 100
+#define KEYPAD_DEBOUNCE_MAX 255
+
+// Livraison des événements: classes de priorité (0 la plus haute), taille de la file
+// par ligne, événements max par appel du thread JavaScript, rafale du plafond de débit
+#define DELIVERY_PRIORITIES 3
+#define DELIVERY_QUEUE 4096
+#define DELIVERY_BUDGET 64
+#define DELIVERY_BURST_MS 100
+#define DELIVERY_WEIGHT_MAX 100
+
+// Règles réflexes: front déclencheur
+#define REFLEX_FALLING 0
+#define REFLEX_RISING 1
+#define REFLEX_BOTH 2
+
+// Événement transmis au callback JavaScript
+typedef struct {
+    int edge;
+    int replayed;
+    uint64_t timestamp_ns; // horodatage noyau (CLOCK_MONOTONIC)
+} gpio_event_t;
+
+// En-tête du fichier d'enregistrement
+typedef struct {
+    char magic[6];
+    uint16_t version;
+    uint64_t count;
+} record_header_t;
+
+// Événement enregistré
 typedef struct {
+    uint64_t timestamp_ns;
+    uint32_t line;
+    uint8_t edge;
+    uint8_t reserved[3];
+} record_event_t;
+
+// Structure pour stocker les lignes GPIO ouvertes
+typedef struct gpio_context {
 #ifdef LIBGPIOD_V2
     struct gpiod_chip *chip;
     struct gpiod_line_request *request;
@@ -39,69 +135,744 @@ typedef struct {
     int line_num;
     int is_output;
     int is_closed;
+    int is_closing; // closeAsync() en cours
+    int is_virtual; // ligne sans matériel alimentée par le rejeu
+    int value;      // dernière valeur rejouée (ligne virtuelle)
+    int wake_fd;    // eventfd pour réveiller immédiatement le thread de la ligne
 
     // Pour le monitoring
-    int is_monitoring;
+    int is_monitoring; // thread d'événements actif (callback JavaScript et/ou règles réflexes)
     pthread_t monitor_thread;
-    napi_threadsafe_function tsfn;
+    int reflex_count; // règles réflexes dont la ligne est l'entrée, accès atomiques
+    struct gpio_context *next_monitor;
+
+    // Livraison au callback JavaScript (verrou de livraison), inactive si seules
+    // des règles réflexes utilisent la ligne
+    int is_delivering;
     napi_ref callback_ref;
+    gpio_event_t *queue;
+    unsigned int queue_head;
+    unsigned int queue_count;
+    int priority;
+    int weight;
+    int credit;         // événements restants dans le tour de la classe
+    double rate;        // plafond en événements/s, 0 sans plafond
+    double tokens;
+    uint64_t tokens_ns;
+    uint64_t delivered;
+    uint64_t throttled; // écartés par le plafond ou file pleine
+    struct delivery *delivery; // ordonnanceur de l'environnement Node de la ligne
+    struct gpio_context *next_delivery;
+
+    // Pour la mesure d'impulsion: verrou des accès hors thread JS à la ligne
+    pthread_mutex_t lock;
+    int is_ranging;
+    pthread_t ranging_thread;
+    napi_threadsafe_function ranging_tsfn;
+    struct gpio_context *ranging_trigger;
+    napi_ref ranging_trigger_ref; // garde le handle du trigger en vie pendant la mesure continue
+    int ranging_pulse_us;
+    int ranging_timeout_ms;
+    int ranging_interval_ms;
+    int pulse_pending; // mesures pulseMeasureAsync en cours, modifié par le thread JavaScript
 } gpio_context_t;
 
-// Libérer les ressources GPIO
-static void finalize_gpio(napi_env env, void* finalize_data, void* finalize_hint) {
-    gpio_context_t *ctx = (gpio_context_t*)finalize_data;
-    if (ctx) {
-        // Arrêter le monitoring si actif
-        if (ctx->is_monitoring) {
-            ctx->is_monitoring = 0;
-            if (ctx->monitor_thread) {
-                pthread_join(ctx->monitor_thread, NULL);
-            }
+// Horloge monotone en ns (même horloge que les horodatages noyau)
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Écrire une valeur sur une ligne de sortie
+static int set_line_value(gpio_context_t *ctx, int value) {
+#ifdef LIBGPIOD_V2
+    return gpiod_line_request_set_value(ctx->request, ctx->offset,
+        value ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE);
+#else
+    return gpiod_line_set_value(ctx->line, value ? 1 : 0);
+#endif
+}
+
+// Réveiller le thread de la ligne (monitoring ou mesure continue)
+static void wake_thread(gpio_context_t *ctx) {
+    uint64_t one = 1;
+    if (write(ctx->wake_fd, &one, sizeof(one)) < 0) {
+        // Compteur déjà non nul: le thread sera réveillé de toute façon
+    }
+}
+
+// Remettre à zéro le compteur de réveil avant de démarrer un thread
+static void wake_reset(gpio_context_t *ctx) {
+    uint64_t count;
+    if (read(ctx->wake_fd, &count, sizeof(count)) < 0) {
+        // EAGAIN: aucun réveil en attente
+    }
+}
+
+// Attendre une échéance absolue (CLOCK_MONOTONIC) sauf réveil, retourne 1 si réveillé
+static int wait_until(gpio_context_t *ctx, const struct timespec *deadline) {
+    uint64_t deadline_ns = (uint64_t)deadline->tv_sec * 1000000000ULL + (uint64_t)deadline->tv_nsec;
+    uint64_t now = monotonic_ns();
+
+    // poll() à la milliseconde près puis fin d'attente précise
+    if (deadline_ns > now + 1000000ULL) {
+        struct pollfd pfd = { .fd = ctx->wake_fd, .events = POLLIN };
+        if (poll(&pfd, 1, (int)((deadline_ns - now) / 1000000ULL)) > 0) {
+            return 1;
         }
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL);
+    return 0;
+}
+
+// Demander l'arrêt de la mesure continue sans attendre
+static void ranging_signal(gpio_context_t *ctx) {
+    if (ctx->is_ranging) {
+        ctx->is_ranging = 0;
+        wake_thread(ctx);
+    }
+}
+
+// Attendre la fin du thread de mesure continue et libérer son callback
+static void ranging_join(gpio_context_t *ctx) {
+    if (ctx->ranging_thread) {
+        pthread_join(ctx->ranging_thread, NULL);
+        ctx->ranging_thread = 0;
+    }
+
+    if (ctx->ranging_tsfn) {
+        napi_release_threadsafe_function(ctx->ranging_tsfn, napi_tsfn_abort);
+        ctx->ranging_tsfn = NULL;
+    }
+    ctx->ranging_trigger = NULL;
+}
+
+// Libérer la référence du trigger, env NULL depuis le finaliseur
+static void ranging_unref(napi_env env, gpio_context_t *ctx) {
+    if (env != NULL && ctx->ranging_trigger_ref) {
+        napi_delete_reference(env, ctx->ranging_trigger_ref);
+    }
+    ctx->ranging_trigger_ref = NULL;
+}
+
+// Arrêter la mesure continue si active
+static void stop_ranging(napi_env env, gpio_context_t *ctx) {
+    ranging_signal(ctx);
+    ranging_join(ctx);
+    ranging_unref(env, ctx);
+}
+
+// Événements rejoués pas encore traités par le thread JavaScript
+static int replay_inflight = 0;
+
+// Livraison des événements vers JavaScript: une file par ligne et un seul appel
+// du thread JavaScript qui sert les classes de priorité dans l'ordre, puis les
+// lignes d'une même classe en tourniquet pondéré. Un ordonnanceur par
+// environnement Node (thread principal ou worker), en données d'instance
+typedef struct delivery {
+    pthread_mutex_t lock;
+    napi_threadsafe_function tsfn;  // NULL avant le premier monitoring et après la fermeture de l'environnement
+    int scheduled;                  // appel du thread JavaScript en attente
+    int lines_count;                // tsfn référencé (maintient Node actif) si > 0
+    int refs;                       // environnement + lignes d'entrée ouvertes
+    gpio_context_t *lines;
+} delivery_t;
+
+// Libérer l'ordonnanceur quand l'environnement et toutes ses lignes l'ont quitté
+static void delivery_release(delivery_t *d) {
+    pthread_mutex_lock(&d->lock);
+    int refs = --d->refs;
+    pthread_mutex_unlock(&d->lock);
+    if (refs == 0) {
+        pthread_mutex_destroy(&d->lock);
+        free(d);
+    }
+}
+
+// Fermeture de l'environnement: Node libère le tsfn, ne plus l'appeler
+static void delivery_env_cleanup(void *arg) {
+    delivery_t *d = (delivery_t*)arg;
+    pthread_mutex_lock(&d->lock);
+    d->tsfn = NULL;
+    pthread_mutex_unlock(&d->lock);
+}
+
+static void delivery_env_finalize(napi_env env, void *data, void *hint) {
+    delivery_release((delivery_t*)data);
+}
+
+// Ordonnanceur de l'environnement, créé au premier appel. Une référence est
+// prise pour la ligne appelante, NULL si erreur
+static delivery_t* delivery_get(napi_env env) {
+    delivery_t *d = NULL;
+    if (napi_get_instance_data(env, (void**)&d) != napi_ok) return NULL;
 
-        if (ctx->tsfn) {
-            napi_release_threadsafe_function(ctx->tsfn, napi_tsfn_abort);
-            ctx->tsfn = NULL;
+    if (!d) {
+        d = (delivery_t*)malloc(sizeof(delivery_t));
+        if (!d) return NULL;
+        memset(d, 0, sizeof(delivery_t));
+        pthread_mutex_init(&d->lock, NULL);
+        d->refs = 1;
+        if (napi_set_instance_data(env, d, delivery_env_finalize, NULL) != napi_ok) {
+            pthread_mutex_destroy(&d->lock);
+            free(d);
+            return NULL;
         }
+        napi_add_env_cleanup_hook(env, delivery_env_cleanup, d);
+    }
 
-        // Ne pas utiliser callback_ref ici car nous n'avons plus d'environnement valide
-        ctx->callback_ref = NULL;
+    pthread_mutex_lock(&d->lock);
+    d->refs++;
+    pthread_mutex_unlock(&d->lock);
+    return d;
+}
 
-        // Ne libérer que si pas déjà fermé
-        if (!ctx->is_closed) {
-#ifdef LIBGPIOD_V2
-            if (ctx->request) {
-                gpiod_line_request_release(ctx->request);
-                ctx->request = NULL;
-            }
-            if (ctx->line_settings) {
-                gpiod_line_settings_free(ctx->line_settings);
-                ctx->line_settings = NULL;
-            }
-            if (ctx->line_cfg) {
-                gpiod_line_config_free(ctx->line_cfg);
-                ctx->line_cfg = NULL;
+// Planifier un appel du thread JavaScript, appelé avec le verrou de livraison
+static void delivery_schedule(delivery_t *d) {
+    if (!d->scheduled && d->tsfn) {
+        d->scheduled = 1;
+        napi_call_threadsafe_function(d->tsfn, NULL, napi_tsfn_nonblocking);
+    }
+}
+
+// Taille du seau à jetons: DELIVERY_BURST_MS d'événements, au moins un
+static double delivery_burst(double rate) {
+    double burst = rate * DELIVERY_BURST_MS / 1000.0;
+    return burst < 1 ? 1 : burst;
+}
+
+// Plafond de débit par seau à jetons, appelé avec le verrou de livraison
+static int delivery_allow(gpio_context_t *ctx) {
+    if (ctx->rate <= 0) return 1;
+
+    uint64_t now = monotonic_ns();
+    double burst = delivery_burst(ctx->rate);
+
+    ctx->tokens += (double)(now - ctx->tokens_ns) * ctx->rate / 1e9;
+    if (ctx->tokens > burst) ctx->tokens = burst;
+    ctx->tokens_ns = now;
+
+    if (ctx->tokens < 1) return 0;
+    ctx->tokens -= 1;
+    return 1;
+}
+
+// Mettre un événement dans la file de la ligne sans jamais attendre: le thread de
+// monitoring exécute aussi les règles réflexes et l'enregistrement, un événement
+// qui ne trouve pas de place est écarté et compté. Retourne 1 si l'événement est en file
+static int delivery_push(gpio_context_t *ctx, int edge, int replayed, uint64_t timestamp_ns) {
+    delivery_t *d = ctx->delivery;
+    if (!d) return 0;
+
+    pthread_mutex_lock(&d->lock);
+    if (!ctx->is_delivering) {
+        pthread_mutex_unlock(&d->lock);
+        return 0;
+    }
+
+    if (!delivery_allow(ctx)) {
+        ctx->throttled++;
+        pthread_mutex_unlock(&d->lock);
+        return 0;
+    }
+
+    if (ctx->queue_count >= DELIVERY_QUEUE) {
+        ctx->throttled++;
+        pthread_mutex_unlock(&d->lock);
+        return 0;
+    }
+
+    gpio_event_t *event = &ctx->queue[(ctx->queue_head + ctx->queue_count) % DELIVERY_QUEUE];
+    event->edge = edge;
+    event->replayed = replayed;
+    event->timestamp_ns = timestamp_ns;
+    ctx->queue_count++;
+    if (replayed) __atomic_fetch_add(&replay_inflight, 1, __ATOMIC_RELAXED);
+
+    delivery_schedule(d);
+    pthread_mutex_unlock(&d->lock);
+    return 1;
+}
+
+// Choisir la prochaine ligne à servir, appelé avec le verrou de livraison
+static gpio_context_t* delivery_pick(delivery_t *d) {
+    for (int priority = 0; priority < DELIVERY_PRIORITIES; priority++) {
+        for (int round = 0; round < 2; round++) {
+            int pending = 0;
+            for (gpio_context_t *ctx = d->lines; ctx; ctx = ctx->next_delivery) {
+                if (ctx->priority != priority || !ctx->queue_count) continue;
+                pending = 1;
+                if (ctx->credit > 0) return ctx;
             }
-            if (ctx->req_cfg) {
-                gpiod_request_config_free(ctx->req_cfg);
-                ctx->req_cfg = NULL;
+            if (!pending) break;
+
+            // Tour terminé pour cette classe: recharger les crédits selon les poids
+            for (gpio_context_t *ctx = d->lines; ctx; ctx = ctx->next_delivery) {
+                if (ctx->priority == priority) ctx->credit = ctx->weight;
             }
-            if (ctx->chip) {
-                gpiod_chip_close(ctx->chip);
-                ctx->chip = NULL;
+        }
+    }
+    return NULL;
+}
+
+// Appelé depuis le thread JavaScript: livrer au plus DELIVERY_BUDGET événements,
+// la suite est replanifiée pour laisser tourner la boucle d'événements
+static void call_js_delivery(napi_env env, napi_value js_callback, void* context, void* data) {
+    delivery_t *d = (delivery_t*)context;
+    if (env == NULL) return; // tsfn en cours de libération avec l'environnement
+
+    pthread_mutex_lock(&d->lock);
+    d->scheduled = 0;
+
+    for (int n = 0; n < DELIVERY_BUDGET; n++) {
+        gpio_context_t *ctx = delivery_pick(d);
+        if (!ctx) break;
+
+        gpio_event_t event = ctx->queue[ctx->queue_head];
+        ctx->queue_head = (ctx->queue_head + 1) % DELIVERY_QUEUE;
+        ctx->queue_count--;
+        ctx->credit--;
+        ctx->delivered++;
+        napi_ref callback_ref = ctx->callback_ref;
+        pthread_mutex_unlock(&d->lock);
+
+        if (event.replayed) {
+            __atomic_fetch_sub(&replay_inflight, 1, __ATOMIC_RELAXED);
+        }
+
+        // Le callback peut arrêter le monitoring: la ligne est choisie à nouveau à chaque tour
+        napi_status status = napi_ok;
+        napi_value callback;
+        if (env != NULL && napi_get_reference_value(env, callback_ref, &callback) == napi_ok && callback != NULL) {
+            napi_value argv[2], global, result;
+            napi_create_int32(env, event.edge, &argv[0]);
+            napi_create_bigint_uint64(env, event.timestamp_ns, &argv[1]);
+            napi_get_global(env, &global);
+            status = napi_call_function(env, global, callback, 2, argv, &result);
+        }
+
+        pthread_mutex_lock(&d->lock);
+        if (status != napi_ok) break; // exception: la laisser remonter, la suite au prochain appel
+    }
+
+    for (gpio_context_t *ctx = d->lines; ctx; ctx = ctx->next_delivery) {
+        if (ctx->queue_count) {
+            delivery_schedule(d);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&d->lock);
+}
+
+// Enregistrer le callback JavaScript de la ligne dans l'ordonnanceur
+static int delivery_add(napi_env env, gpio_context_t *ctx, napi_value callback, int priority, int weight, double rate) {
+    delivery_t *d = ctx->delivery;
+    if (!d) return -1;
+
+    if (!d->tsfn) {
+        napi_value resource_name;
+        napi_create_string_utf8(env, "GPIOMonitor", NAPI_AUTO_LENGTH, &resource_name);
+        if (napi_create_threadsafe_function(env, NULL, NULL, resource_name, 0, 1,
+                NULL, NULL, d, call_js_delivery, &d->tsfn) != napi_ok) {
+            d->tsfn = NULL;
+            return -1;
+        }
+    } else if (d->lines_count == 0) {
+        napi_ref_threadsafe_function(env, d->tsfn);
+    }
+
+    gpio_event_t *queue = (gpio_event_t*)malloc(DELIVERY_QUEUE * sizeof(gpio_event_t));
+    if (!queue || napi_create_reference(env, callback, 1, &ctx->callback_ref) != napi_ok) {
+        free(queue);
+        if (d->lines_count == 0) napi_unref_threadsafe_function(env, d->tsfn);
+        return -1;
+    }
+
+    pthread_mutex_lock(&d->lock);
+    ctx->queue = queue;
+    ctx->queue_head = 0;
+    ctx->queue_count = 0;
+    ctx->priority = priority;
+    ctx->weight = weight;
+    ctx->credit = weight;
+    ctx->rate = rate;
+    ctx->tokens = delivery_burst(rate);
+    ctx->tokens_ns = monotonic_ns();
+    ctx->delivered = 0;
+    ctx->throttled = 0;
+    ctx->is_delivering = 1;
+    ctx->next_delivery = d->lines;
+    d->lines = ctx;
+    d->lines_count++;
+    pthread_mutex_unlock(&d->lock);
+    return 0;
+}
+
+// Retirer la ligne de l'ordonnanceur, les événements en attente sont abandonnés
+// (env NULL pendant la finalisation: référence et tsfn laissés à Node)
+static void delivery_remove(napi_env env, gpio_context_t *ctx) {
+    delivery_t *d = ctx->delivery;
+    if (!d) return;
+
+    pthread_mutex_lock(&d->lock);
+    if (!ctx->is_delivering) {
+        pthread_mutex_unlock(&d->lock);
+        return;
+    }
+
+    for (gpio_context_t **p = &d->lines; *p; p = &(*p)->next_delivery) {
+        if (*p == ctx) {
+            *p = ctx->next_delivery;
+            break;
+        }
+    }
+    for (unsigned int i = 0; i < ctx->queue_count; i++) {
+        if (ctx->queue[(ctx->queue_head + i) % DELIVERY_QUEUE].replayed) {
+            __atomic_fetch_sub(&replay_inflight, 1, __ATOMIC_RELAXED);
+        }
+    }
+    ctx->is_delivering = 0;
+    ctx->queue_count = 0;
+    free(ctx->queue);
+    ctx->queue = NULL;
+    d->lines_count--;
+    int idle = d->lines_count == 0;
+    pthread_mutex_unlock(&d->lock);
+
+    if (env != NULL) {
+        napi_delete_reference(env, ctx->callback_ref);
+        if (idle) napi_unref_threadsafe_function(env, d->tsfn);
+    }
+    ctx->callback_ref = NULL;
+}
+
+// Lignes en cours de monitoring, destinataires du rejeu
+static pthread_mutex_t monitors_lock = PTHREAD_MUTEX_INITIALIZER;
+static gpio_context_t *monitors = NULL;
+
+// Demander l'arrêt du monitoring sans attendre: le thread est réveillé immédiatement
+static void monitoring_signal(napi_env env, gpio_context_t *ctx) {
+    delivery_remove(env, ctx);
+    if (ctx->is_monitoring) {
+        pthread_mutex_lock(&monitors_lock);
+        for (gpio_context_t **p = &monitors; *p; p = &(*p)->next_monitor) {
+            if (*p == ctx) {
+                *p = ctx->next_monitor;
+                break;
             }
+        }
+        ctx->is_monitoring = 0;
+        pthread_mutex_unlock(&monitors_lock);
+        wake_thread(ctx);
+    }
+}
+
+// Attendre la fin du thread de monitoring
+static void monitoring_join(gpio_context_t *ctx) {
+    if (ctx->monitor_thread) {
+        pthread_join(ctx->monitor_thread, NULL);
+        ctx->monitor_thread = 0;
+    }
+}
+
+// Arrêter le monitoring si actif
+static void stop_monitoring(napi_env env, gpio_context_t *ctx) {
+    monitoring_signal(env, ctx);
+    monitoring_join(ctx);
+}
+
+// Libérer la ligne et le chip (threads déjà arrêtés)
+static void release_line(gpio_context_t *ctx) {
+#ifdef LIBGPIOD_V2
+    if (ctx->request) {
+        gpiod_line_request_release(ctx->request);
+        ctx->request = NULL;
+    }
+    if (ctx->line_settings) {
+        gpiod_line_settings_free(ctx->line_settings);
+        ctx->line_settings = NULL;
+    }
+    if (ctx->line_cfg) {
+        gpiod_line_config_free(ctx->line_cfg);
+        ctx->line_cfg = NULL;
+    }
+    if (ctx->req_cfg) {
+        gpiod_request_config_free(ctx->req_cfg);
+        ctx->req_cfg = NULL;
+    }
+    if (ctx->chip) {
+        gpiod_chip_close(ctx->chip);
+        ctx->chip = NULL;
+    }
 #else
-            if (ctx->line) {
-                gpiod_line_release(ctx->line);
-                ctx->line = NULL;
+    if (ctx->line) {
+        gpiod_line_release(ctx->line);
+        ctx->line = NULL;
+    }
+    if (ctx->chip) {
+        gpiod_chip_close(ctx->chip);
+        ctx->chip = NULL;
+    }
+#endif
+    ctx->is_closed = 1;
+}
+
+// Enregistreur d'événements: fichier projeté en mémoire, ajout seul
+static struct {
+    pthread_mutex_t lock;
+    volatile int active;
+    int fd;
+    uint8_t *map;
+    size_t capacity; // en enregistrements
+} recorder = { .lock = PTHREAD_MUTEX_INITIALIZER, .fd = -1 };
+
+// Projeter le fichier d'enregistrement pour la capacité demandée
+static int recorder_map(size_t capacity) {
+    size_t size = sizeof(record_header_t) + capacity * sizeof(record_event_t);
+
+    if (recorder.map) {
+        munmap(recorder.map, sizeof(record_header_t) + recorder.capacity * sizeof(record_event_t));
+        recorder.map = NULL;
+    }
+
+    if (ftruncate(recorder.fd, (off_t)size) < 0) {
+        return -1;
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, recorder.fd, 0);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    recorder.map = (uint8_t*)map;
+    recorder.capacity = capacity;
+    return 0;
+}
+
+// Ajouter un événement à l'enregistrement (appelé par les threads de monitoring)
+static void record_event(int line_num, int edge, uint64_t timestamp_ns) {
+    pthread_mutex_lock(&recorder.lock);
+    if (recorder.active) {
+        record_header_t *header = (record_header_t*)recorder.map;
+        if (header->count >= recorder.capacity) {
+            if (recorder_map(recorder.capacity + RECORD_CHUNK) < 0) {
+                // Disque plein ou erreur: arrêter l'enregistrement, le fichier reste valide
+                recorder.active = 0;
+                pthread_mutex_unlock(&recorder.lock);
+                return;
+            }
+            header = (record_header_t*)recorder.map;
+        }
+
+        record_event_t *event = (record_event_t*)(recorder.map + sizeof(record_header_t)) + header->count;
+        event->timestamp_ns = timestamp_ns;
+        event->line = (uint32_t)line_num;
+        event->edge = (uint8_t)edge;
+        memset(event->reserved, 0, sizeof(event->reserved));
+        header->count++;
+    }
+    pthread_mutex_unlock(&recorder.lock);
+}
+
+// Règle réflexe: un front sur une entrée écrit une valeur sur une sortie depuis le thread
+// d'événements, sans passer par le thread JavaScript
+typedef struct reflex_rule {
+    int id;
+    gpio_context_t *input;
+    gpio_context_t *output;
+    napi_ref input_ref;     // garde les deux lignes en vie tant que la règle existe
+    napi_ref output_ref;
+    int edge;               // REFLEX_RISING, REFLEX_FALLING ou REFLEX_BOTH
+    int value;
+    int latch;              // une seule exécution jusqu'à reflexReset()
+    int fired;
+    uint64_t delay_ns;
+    uint64_t due_ns;        // action différée en attente, 0 sinon
+    int due_edge;
+    uint64_t due_timestamp_ns;
+    napi_threadsafe_function tsfn; // notification JavaScript, NULL sans callback
+    struct reflex_rule *next;
+} reflex_rule_t;
+
+// Notification d'une action réflexe
+typedef struct {
+    int edge;
+    uint64_t timestamp_ns;  // horodatage noyau du front déclencheur
+    uint64_t action_ns;     // instant de l'écriture sur la sortie
+} reflex_event_t;
+
+// Table des règles et thread des actions différées
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    int running;
+    int next_id;
+    reflex_rule_t *rules;
+} reflex = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// Écrire la sortie puis notifier JavaScript, appelé avec le verrou des réflexes
+static void reflex_fire(reflex_rule_t *rule, int edge, uint64_t timestamp_ns) {
+    set_line_value(rule->output, rule->value);
+
+    if (rule->tsfn) {
+        reflex_event_t *data = (reflex_event_t*)malloc(sizeof(reflex_event_t));
+        if (data) {
+            data->edge = edge;
+            data->timestamp_ns = timestamp_ns;
+            data->action_ns = monotonic_ns();
+            napi_call_threadsafe_function(rule->tsfn, data, napi_tsfn_nonblocking);
+        }
+    }
+}
+
+// Appliquer les règles d'une entrée à un front (thread d'événements ou rejeu)
+static void reflex_apply(gpio_context_t *ctx, int edge, uint64_t timestamp_ns) {
+    pthread_mutex_lock(&reflex.lock);
+    for (reflex_rule_t *rule = reflex.rules; rule; rule = rule->next) {
+        if (rule->input != ctx || (rule->latch && rule->fired)) continue;
+        if (rule->edge != REFLEX_BOTH && rule->edge != edge) continue;
+
+        rule->fired = 1;
+        if (!rule->delay_ns) {
+            reflex_fire(rule, edge, timestamp_ns);
+        } else if (!rule->due_ns) {
+            // Action différée: une seule en attente par règle
+            rule->due_ns = monotonic_ns() + rule->delay_ns;
+            rule->due_edge = edge;
+            rule->due_timestamp_ns = timestamp_ns;
+            pthread_cond_signal(&reflex.cond);
+        }
+    }
+    pthread_mutex_unlock(&reflex.lock);
+}
+
+// Thread des actions différées: exécuter chaque action à son échéance
+static void* reflex_thread_func(void* arg) {
+    pthread_mutex_lock(&reflex.lock);
+
+    while (reflex.running) {
+        uint64_t now = monotonic_ns();
+        uint64_t wake = 0;
+
+        for (reflex_rule_t *rule = reflex.rules; rule; rule = rule->next) {
+            if (!rule->due_ns) continue;
+            if (rule->due_ns <= now) {
+                rule->due_ns = 0;
+                reflex_fire(rule, rule->due_edge, rule->due_timestamp_ns);
+            } else if (!wake || rule->due_ns < wake) {
+                wake = rule->due_ns;
             }
-            if (ctx->chip) {
-                gpiod_chip_close(ctx->chip);
-                ctx->chip = NULL;
+        }
+
+        if (!wake) {
+            pthread_cond_wait(&reflex.cond, &reflex.lock);
+        } else {
+            struct timespec ts;
+            ts.tv_sec = wake / 1000000000ULL;
+            ts.tv_nsec = wake % 1000000000ULL;
+            pthread_cond_timedwait(&reflex.cond, &reflex.lock, &ts);
+        }
+    }
+
+    pthread_mutex_unlock(&reflex.lock);
+    return NULL;
+}
+
+// Retirer une règle de la table, appelé avec le verrou des réflexes
+static void reflex_unlink(napi_env env, reflex_rule_t *rule) {
+    for (reflex_rule_t **p = &reflex.rules; *p; p = &(*p)->next) {
+        if (*p == rule) {
+            *p = rule->next;
+            break;
+        }
+    }
+    __atomic_sub_fetch(&rule->input->reflex_count, 1, __ATOMIC_RELEASE);
+
+    if (rule->tsfn) {
+        napi_release_threadsafe_function(rule->tsfn, napi_tsfn_abort);
+    }
+    if (env != NULL) {
+        napi_delete_reference(env, rule->input_ref);
+        napi_delete_reference(env, rule->output_ref);
+    }
+    free(rule);
+}
+
+// Arrêter le thread des actions différées quand il n'y a plus de règle
+static void reflex_thread_stop_if_idle(void) {
+    pthread_t thread = 0;
+
+    pthread_mutex_lock(&reflex.lock);
+    if (!reflex.rules && reflex.running) {
+        reflex.running = 0;
+        thread = reflex.thread;
+        pthread_cond_signal(&reflex.cond);
+    }
+    pthread_mutex_unlock(&reflex.lock);
+
+    if (thread) {
+        pthread_join(thread, NULL);
+        pthread_cond_destroy(&reflex.cond);
+    }
+}
+
+// Arrêter les threads d'événements qui n'ont plus ni callback ni règle réflexe
+static void reflex_stop_idle_inputs(napi_env env, gpio_context_t *except) {
+    for (;;) {
+        gpio_context_t *idle = NULL;
+        pthread_mutex_lock(&monitors_lock);
+        for (gpio_context_t *ctx = monitors; ctx; ctx = ctx->next_monitor) {
+            if (ctx != except && !ctx->is_delivering && !__atomic_load_n(&ctx->reflex_count, __ATOMIC_ACQUIRE)) {
+                idle = ctx;
+                break;
             }
-#endif
-            ctx->is_closed = 1;
         }
+        pthread_mutex_unlock(&monitors_lock);
+
+        if (!idle) break;
+        stop_monitoring(env, idle);
+    }
+}
+
+// Retirer toutes les règles qui utilisent une ligne (fermeture de la ligne)
+static void reflex_remove_ctx(napi_env env, gpio_context_t *ctx) {
+    pthread_mutex_lock(&reflex.lock);
+    reflex_rule_t *rule = reflex.rules;
+    while (rule) {
+        reflex_rule_t *next = rule->next;
+        if (rule->input == ctx || rule->output == ctx) {
+            reflex_unlink(env, rule);
+        }
+        rule = next;
+    }
+    pthread_mutex_unlock(&reflex.lock);
+    reflex_thread_stop_if_idle();
+    reflex_stop_idle_inputs(env, ctx);
+}
+
+// Libérer les ressources GPIO
+static void finalize_gpio(napi_env env, void* finalize_data, void* finalize_hint) {
+    gpio_context_t *ctx = (gpio_context_t*)finalize_data;
+    if (ctx) {
+        // Retirer les règles réflexes puis arrêter le monitoring si actif
+        // Ne pas utiliser les références ici car nous n'avons plus d'environnement valide
+        reflex_remove_ctx(NULL, ctx);
+        stop_monitoring(NULL, ctx);
+        stop_ranging(NULL, ctx);
+        if (ctx->delivery) {
+            delivery_release(ctx->delivery);
+        }
+
+        // Ne libérer que si pas déjà fermé
+        if (!ctx->is_closed) {
+            release_line(ctx);
+        }
+        if (ctx->wake_fd >= 0) {
+            close(ctx->wake_fd);
+        }
+        pthread_mutex_destroy(&ctx->lock);
         free(ctx);
     }
 }
@@ -186,7 +957,6 @@ static napi_value OpenOutput(napi_env env, napi_callback_info info) {
     ctx->is_closed = 0;
     ctx->is_monitoring = 0;
     ctx->monitor_thread = 0;
-    ctx->tsfn = NULL;
     ctx->callback_ref = NULL;
 
 #ifdef LIBGPIOD_V2
@@ -270,8 +1040,16 @@ static napi_value OpenOutput(napi_env env, napi_callback_info info) {
     }
 #endif
 
-    napi_value external;
-    status = napi_create_external(env, ctx, finalize_gpio, NULL, &external);
+    pthread_mutex_init(&ctx->lock, NULL);
+    ctx->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (ctx->wake_fd < 0) {
+        finalize_gpio(env, ctx, NULL);
+        napi_throw_error(env, NULL, "Failed to create wakeup eventfd");
+        return NULL;
+    }
+
+    napi_value external;
+    status = napi_create_external(env, ctx, finalize_gpio, NULL, &external);
     if (status != napi_ok) {
         finalize_gpio(env, ctx, NULL);
         napi_throw_error(env, NULL, "Failed to create external");
@@ -329,7 +1107,6 @@ static napi_value OpenInput(napi_env env, napi_callback_info info) {
     ctx->is_closed = 0;
     ctx->is_monitoring = 0;
     ctx->monitor_thread = 0;
-    ctx->tsfn = NULL;
     ctx->callback_ref = NULL;
 
 #ifdef LIBGPIOD_V2
@@ -439,6 +1216,21 @@ static napi_value OpenInput(napi_env env, napi_callback_info info) {
     }
 #endif
 
+    pthread_mutex_init(&ctx->lock, NULL);
+    ctx->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (ctx->wake_fd < 0) {
+        finalize_gpio(env, ctx, NULL);
+        napi_throw_error(env, NULL, "Failed to create wakeup eventfd");
+        return NULL;
+    }
+
+    ctx->delivery = delivery_get(env);
+    if (!ctx->delivery) {
+        finalize_gpio(env, ctx, NULL);
+        napi_throw_error(env, NULL, "Failed to create event scheduler");
+        return NULL;
+    }
+
     napi_value external;
     status = napi_create_external(env, ctx, finalize_gpio, NULL, &external);
     if (status != napi_ok) {
@@ -450,55 +1242,75 @@ static napi_value OpenInput(napi_env env, napi_callback_info info) {
     return external;
 }
 
+// Traiter un front lu sur la ligne: règles réflexes d'abord, puis enregistrement et JavaScript
+static void monitor_dispatch(gpio_context_t *ctx, int edge, uint64_t timestamp_ns) {
+    if (__atomic_load_n(&ctx->reflex_count, __ATOMIC_ACQUIRE)) reflex_apply(ctx, edge, timestamp_ns);
+    if (recorder.active) record_event(ctx->line_num, edge, timestamp_ns);
+
+    if (ctx->is_delivering) delivery_push(ctx, edge, 0, timestamp_ns);
+}
+
 // Thread de monitoring des événements
 static void* monitor_thread_func(void* arg) {
     gpio_context_t *ctx = (gpio_context_t*)arg;
 
 #ifdef LIBGPIOD_V2
-    struct gpiod_edge_event_buffer *event_buffer = gpiod_edge_event_buffer_new(1);
+    // Lire plusieurs événements par réveil pour absorber les rafales
+    struct gpiod_edge_event_buffer *event_buffer = gpiod_edge_event_buffer_new(GPIO_EVENT_BATCH);
     if (!event_buffer) return NULL;
 
+    // Attente sans timeout: événement de la ligne ou réveil par stopMonitoring/close
+    struct pollfd pfds[2] = {
+        { .fd = gpiod_line_request_get_fd(ctx->request), .events = POLLIN },
+        { .fd = ctx->wake_fd, .events = POLLIN }
+    };
+
     while (ctx->is_monitoring && !ctx->is_closed) {
-        // Timeout de 100ms (100000000 nanosecondes)
-        int ret = gpiod_line_request_wait_edge_events(ctx->request, 100000000);
-        if (ret > 0) {
-            ret = gpiod_line_request_read_edge_events(ctx->request, event_buffer, 1);
-            if (ret > 0) {
-                struct gpiod_edge_event *event = gpiod_edge_event_buffer_get_event(event_buffer, 0);
+        int ret = poll(pfds, 2, -1);
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret < 0 || (pfds[0].revents & (POLLERR | POLLHUP | POLLNVAL))) break;
+        if (pfds[1].revents) {
+            wake_reset(ctx); // réveil: vérifier is_monitoring
+            continue;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            ret = gpiod_line_request_read_edge_events(ctx->request, event_buffer, GPIO_EVENT_BATCH);
+            for (int i = 0; i < ret; i++) {
+                struct gpiod_edge_event *event = gpiod_edge_event_buffer_get_event(event_buffer, i);
                 if (event) {
                     enum gpiod_edge_event_type edge_type = gpiod_edge_event_get_event_type(event);
-
-                    // Créer les données à passer au callback JavaScript
-                    int *data = (int*)malloc(sizeof(int));
-                    if (data) {
-                        *data = (edge_type == GPIOD_EDGE_EVENT_RISING_EDGE) ? 1 : 0;
-                        napi_call_threadsafe_function(ctx->tsfn, data, napi_tsfn_blocking);
-                    }
+                    monitor_dispatch(ctx, (edge_type == GPIOD_EDGE_EVENT_RISING_EDGE) ? 1 : 0,
+                        gpiod_edge_event_get_timestamp_ns(event));
                 }
             }
-        } else if (ret < 0 && ret != -ETIMEDOUT) {
-            // Erreur autre que timeout
-            break;
         }
     }
 
     gpiod_edge_event_buffer_free(event_buffer);
 #else
-    struct gpiod_line_event event;
-    struct timespec timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_nsec = 100000000; // 100ms
+    struct gpiod_line_event events[GPIO_EVENT_BATCH];
+
+    // Attente sans timeout: événement de la ligne ou réveil par stopMonitoring/close
+    struct pollfd pfds[2] = {
+        { .fd = gpiod_line_event_get_fd(ctx->line), .events = POLLIN },
+        { .fd = ctx->wake_fd, .events = POLLIN }
+    };
 
     while (ctx->is_monitoring && !ctx->is_closed) {
-        int ret = gpiod_line_event_wait(ctx->line, &timeout);
-        if (ret > 0) {
-            ret = gpiod_line_event_read(ctx->line, &event);
-            if (ret == 0) {
-                int *data = (int*)malloc(sizeof(int));
-                if (data) {
-                    *data = (event.event_type == GPIOD_LINE_EVENT_RISING_EDGE) ? 1 : 0;
-                    napi_call_threadsafe_function(ctx->tsfn, data, napi_tsfn_blocking);
-                }
+        int ret = poll(pfds, 2, -1);
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret < 0 || (pfds[0].revents & (POLLERR | POLLHUP | POLLNVAL))) break;
+        if (pfds[1].revents) {
+            wake_reset(ctx); // réveil: vérifier is_monitoring
+            continue;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            ret = gpiod_line_event_read_multiple(ctx->line, events, GPIO_EVENT_BATCH);
+            for (int i = 0; i < ret; i++) {
+                monitor_dispatch(ctx, (events[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE) ? 1 : 0,
+                    (uint64_t)events[i].ts.tv_sec * 1000000000ULL + (uint64_t)events[i].ts.tv_nsec);
             }
         }
     }
@@ -507,38 +1319,32 @@ static void* monitor_thread_func(void* arg) {
     return NULL;
 }
 
-// Callback appelé depuis le thread JavaScript
-static void call_js_callback(napi_env env, napi_value js_callback, void* context, void* data) {
-    if (data == NULL) {
-        return;
-    }
-
-    int *edge = (int*)data;
-
-    if (env != NULL && js_callback != NULL) {
-        napi_value argv[1];
-        napi_status status = napi_create_int32(env, *edge, &argv[0]);
-
-        if (status == napi_ok) {
-            napi_value global;
-            status = napi_get_global(env, &global);
-
-            if (status == napi_ok) {
-                napi_value result;
-                napi_call_function(env, global, js_callback, 1, argv, &result);
-            }
-        }
+// Démarrer le thread d'événements (une ligne virtuelle n'est alimentée que par le rejeu)
+static int event_thread_start(gpio_context_t *ctx) {
+    wake_reset(ctx);
+    ctx->is_monitoring = 1;
+    if (!ctx->is_virtual && pthread_create(&ctx->monitor_thread, NULL, monitor_thread_func, ctx) != 0) {
+        ctx->is_monitoring = 0;
+        ctx->monitor_thread = 0;
+        return -1;
     }
 
-    free(data);
+    pthread_mutex_lock(&monitors_lock);
+    ctx->next_monitor = monitors;
+    monitors = ctx;
+    pthread_mutex_unlock(&monitors_lock);
+    return 0;
 }
 
-// Fonction: startMonitoring(handle, callback)
+// Fonction: startMonitoring(handle, callback, [priority, weight, rate])
+// priority: 0 (haute) à 2 (basse), weight: part du tourniquet, rate: plafond en événements/s
 static napi_value StartMonitoring(napi_env env, napi_callback_info info) {
     napi_status status;
-    size_t argc = 2;
-    napi_value args[2];
+    size_t argc = 5;
+    napi_value args[5];
     gpio_context_t *ctx = NULL;
+    int priority = 1, weight = 1;
+    double rate = 0;
 
     status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
     if (status != napi_ok || argc < 2) {
@@ -552,7 +1358,7 @@ static napi_value StartMonitoring(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
-    if (ctx->is_closed) {
+    if (ctx->is_closed || ctx->is_closing) {
         napi_throw_error(env, NULL, "GPIO handle has been closed");
         return NULL;
     }
@@ -562,40 +1368,39 @@ static napi_value StartMonitoring(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
-    if (ctx->is_monitoring) {
+    if (ctx->is_delivering) {
         napi_throw_error(env, NULL, "Monitoring already started");
         return NULL;
     }
 
-    // Créer une threadsafe function
-    napi_value async_resource_name;
-    napi_create_string_utf8(env, "GPIOMonitor", NAPI_AUTO_LENGTH, &async_resource_name);
+    if (ctx->is_ranging) {
+        napi_throw_error(env, NULL, "Cannot monitor GPIO while ranging");
+        return NULL;
+    }
 
-    status = napi_create_threadsafe_function(
-        env,
-        args[1],
-        NULL,
-        async_resource_name,
-        0,
-        1,
-        NULL,
-        NULL,
-        ctx,
-        call_js_callback,
-        &ctx->tsfn
-    );
+    // Le thread d'événements lirait les fronts attendus par la mesure
+    if (ctx->pulse_pending) {
+        napi_throw_error(env, NULL, "Cannot monitor GPIO during pulse measurement");
+        return NULL;
+    }
 
-    if (status != napi_ok) {
+    if ((argc > 2 && napi_get_value_int32(env, args[2], &priority) != napi_ok) ||
+        (argc > 3 && napi_get_value_int32(env, args[3], &weight) != napi_ok) ||
+        (argc > 4 && napi_get_value_double(env, args[4], &rate) != napi_ok) ||
+        priority < 0 || priority >= DELIVERY_PRIORITIES ||
+        weight < 1 || weight > DELIVERY_WEIGHT_MAX || !(rate >= 0)) {
+        napi_throw_error(env, NULL, "Invalid monitoring priority, weight or rate");
+        return NULL;
+    }
+
+    if (delivery_add(env, ctx, args[1], priority, weight, rate) < 0) {
         napi_throw_error(env, NULL, "Failed to create threadsafe function");
         return NULL;
     }
 
-    // Démarrer le thread de monitoring
-    ctx->is_monitoring = 1;
-    if (pthread_create(&ctx->monitor_thread, NULL, monitor_thread_func, ctx) != 0) {
-        ctx->is_monitoring = 0;
-        napi_release_threadsafe_function(ctx->tsfn, napi_tsfn_release);
-        ctx->tsfn = NULL;
+    // Thread déjà démarré si des règles réflexes utilisent la ligne
+    if (!ctx->is_monitoring && event_thread_start(ctx) < 0) {
+        delivery_remove(env, ctx);
         napi_throw_error(env, NULL, "Failed to create monitor thread");
         return NULL;
     }
@@ -625,19 +1430,377 @@ static napi_value StopMonitoring(napi_env env, napi_callback_info info) {
         return result;
     }
 
-    if (ctx->is_monitoring) {
-        ctx->is_monitoring = 0;
-        if (ctx->monitor_thread) {
-            pthread_join(ctx->monitor_thread, NULL);
-            ctx->monitor_thread = 0;
+    // closeAsync() en cours: le thread est déjà arrêté par close_execute
+    if (ctx->is_closing) {
+        napi_value result;
+        napi_get_undefined(env, &result);
+        return result;
+    }
+
+    // Les règles réflexes de la ligne continuent sans callback JavaScript
+    if (__atomic_load_n(&ctx->reflex_count, __ATOMIC_ACQUIRE) && !ctx->is_closed) {
+        delivery_remove(env, ctx);
+    } else {
+        stop_monitoring(env, ctx);
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fonction: monitoringStats(handle) - Retourne {delivered, throttled, pending}
+static napi_value MonitoringStats(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    gpio_context_t *ctx = NULL;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected handle argument");
+        return NULL;
+    }
+
+    status = napi_get_value_external(env, args[0], (void**)&ctx);
+    if (status != napi_ok || ctx == NULL) {
+        napi_throw_error(env, NULL, "Invalid GPIO handle");
+        return NULL;
+    }
+
+    uint64_t delivered = 0, throttled = 0;
+    unsigned int pending = 0;
+    if (ctx->delivery) {
+        pthread_mutex_lock(&ctx->delivery->lock);
+        delivered = ctx->delivered;
+        throttled = ctx->throttled;
+        pending = ctx->queue_count;
+        pthread_mutex_unlock(&ctx->delivery->lock);
+    }
+
+    napi_value result, value;
+    napi_create_object(env, &result);
+    napi_create_int64(env, (int64_t)delivered, &value);
+    napi_set_named_property(env, result, "delivered", value);
+    napi_create_int64(env, (int64_t)throttled, &value);
+    napi_set_named_property(env, result, "throttled", value);
+    napi_create_uint32(env, pending, &value);
+    napi_set_named_property(env, result, "pending", value);
+    return result;
+}
+
+// Fonction: openReplay(lineNumber) - ligne d'entrée virtuelle alimentée par le rejeu
+static napi_value OpenReplay(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    int line_num;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected lineNumber argument");
+        return NULL;
+    }
+
+    status = napi_get_value_int32(env, args[0], &line_num);
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Invalid line number");
+        return NULL;
+    }
+
+    gpio_context_t *ctx = (gpio_context_t*)malloc(sizeof(gpio_context_t));
+    if (!ctx) {
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+    memset(ctx, 0, sizeof(gpio_context_t));
+
+    ctx->line_num = line_num;
+    ctx->is_virtual = 1;
+    pthread_mutex_init(&ctx->lock, NULL);
+    ctx->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (ctx->wake_fd < 0) {
+        finalize_gpio(env, ctx, NULL);
+        napi_throw_error(env, NULL, "Failed to create wakeup eventfd");
+        return NULL;
+    }
+
+    ctx->delivery = delivery_get(env);
+    if (!ctx->delivery) {
+        finalize_gpio(env, ctx, NULL);
+        napi_throw_error(env, NULL, "Failed to create event scheduler");
+        return NULL;
+    }
+
+    napi_value external;
+    status = napi_create_external(env, ctx, finalize_gpio, NULL, &external);
+    if (status != napi_ok) {
+        finalize_gpio(env, ctx, NULL);
+        napi_throw_error(env, NULL, "Failed to create external");
+        return NULL;
+    }
+
+    return external;
+}
+
+// Fonction: recordStart(path) - enregistrer les événements de toutes les lignes surveillées
+static napi_value RecordStart(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    char path[256];
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 1 ||
+        napi_get_value_string_utf8(env, args[0], path, sizeof(path), NULL) != napi_ok) {
+        napi_throw_error(env, NULL, "Expected path argument");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&recorder.lock);
+    if (recorder.fd >= 0) {
+        pthread_mutex_unlock(&recorder.lock);
+        napi_throw_error(env, NULL, "Recording already started");
+        return NULL;
+    }
+
+    recorder.fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (recorder.fd < 0 || recorder_map(RECORD_CHUNK) < 0) {
+        if (recorder.fd >= 0) close(recorder.fd);
+        recorder.fd = -1;
+        pthread_mutex_unlock(&recorder.lock);
+        napi_throw_error(env, NULL, "Failed to create record file");
+        return NULL;
+    }
+
+    record_header_t *header = (record_header_t*)recorder.map;
+    memcpy(header->magic, RECORD_MAGIC, sizeof(header->magic));
+    header->version = RECORD_VERSION;
+    header->count = 0;
+    recorder.active = 1;
+    pthread_mutex_unlock(&recorder.lock);
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fonction: recordStop() - retourne le nombre d'événements enregistrés
+static napi_value RecordStop(napi_env env, napi_callback_info info) {
+    uint64_t count = 0;
+
+    pthread_mutex_lock(&recorder.lock);
+    if (recorder.fd >= 0) {
+        count = ((record_header_t*)recorder.map)->count;
+        munmap(recorder.map, sizeof(record_header_t) + recorder.capacity * sizeof(record_event_t));
+        recorder.map = NULL;
+        recorder.capacity = 0;
+
+        // Ramener le fichier à sa taille utile
+        if (ftruncate(recorder.fd, (off_t)(sizeof(record_header_t) + count * sizeof(record_event_t))) < 0) {
+            // Le fichier reste lisible, seule la fin est inutilisée
+        }
+        close(recorder.fd);
+        recorder.fd = -1;
+    }
+    recorder.active = 0;
+    pthread_mutex_unlock(&recorder.lock);
+
+    napi_value result;
+    napi_create_double(env, (double)count, &result);
+    return result;
+}
+
+// Rejeu d'un enregistrement vers les lignes surveillées
+static struct {
+    volatile int active;
+    int running;
+    pthread_t thread;
+    napi_threadsafe_function tsfn;
+    uint8_t *map;
+    size_t size;
+    int realtime;
+    double speed;
+    uint64_t delivered;
+} replay;
+
+// Transmettre un événement rejoué aux lignes surveillées de même numéro
+static void replay_dispatch(const record_event_t *record) {
+    pthread_mutex_lock(&monitors_lock);
+    for (gpio_context_t *ctx = monitors; ctx; ctx = ctx->next_monitor) {
+        if (ctx->line_num != (int)record->line) continue;
+
+        if (ctx->is_virtual) ctx->value = record->edge ? 1 : 0;
+        if (__atomic_load_n(&ctx->reflex_count, __ATOMIC_ACQUIRE)) reflex_apply(ctx, record->edge ? 1 : 0, record->timestamp_ns);
+        if (!ctx->is_delivering) continue;
+
+        if (delivery_push(ctx, record->edge ? 1 : 0, 1, record->timestamp_ns)) {
+            replay.delivered++;
         }
+    }
+    pthread_mutex_unlock(&monitors_lock);
+}
 
-        if (ctx->tsfn) {
-            napi_release_threadsafe_function(ctx->tsfn, napi_tsfn_abort);
-            ctx->tsfn = NULL;
+// Thread de rejeu: en temps réel (à la vitesse demandée) ou au plus vite
+static void* replay_thread_func(void* arg) {
+    record_header_t *header = (record_header_t*)replay.map;
+    record_event_t *records = (record_event_t*)(replay.map + sizeof(record_header_t));
+    uint64_t start = monotonic_ns();
+
+    // Les threads de surveillance de plusieurs lignes peuvent écrire leurs événements
+    // dans le désordre: le plus ancien horodatage sert d'origine, un événement en
+    // retard sur le précédent est transmis sans attente
+    uint64_t origin = header->count ? records[0].timestamp_ns : 0;
+    for (uint64_t i = 1; i < header->count; i++) {
+        if (records[i].timestamp_ns < origin) origin = records[i].timestamp_ns;
+    }
+
+    for (uint64_t i = 0; i < header->count && replay.active; i++) {
+        if (replay.realtime) {
+            // Attente par tranches de 10ms au plus pour que replayStop() reste réactif
+            uint64_t target = start + (uint64_t)((double)(records[i].timestamp_ns - origin) / replay.speed);
+            uint64_t now;
+            while (replay.active && (now = monotonic_ns()) < target) {
+                uint64_t wake = target - now > 10000000ULL ? now + 10000000ULL : target;
+                struct timespec ts;
+                ts.tv_sec = wake / 1000000000ULL;
+                ts.tv_nsec = wake % 1000000000ULL;
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+            }
+            if (!replay.active) break;
+        } else {
+            // Limiter la file d'attente du thread JavaScript
+            struct timespec pause = {0, 100000};
+            while (replay.active && __atomic_load_n(&replay_inflight, __ATOMIC_RELAXED) >= REPLAY_INFLIGHT_MAX) {
+                nanosleep(&pause, NULL);
+            }
         }
+        replay_dispatch(&records[i]);
+    }
+
+    munmap(replay.map, replay.size);
+    replay.map = NULL;
+
+    // Résoudre la promesse avec le nombre d'événements transmis
+    uint64_t *delivered = (uint64_t*)malloc(sizeof(uint64_t));
+    if (delivered) {
+        *delivered = replay.delivered;
+    }
+    napi_threadsafe_function tsfn = replay.tsfn;
+    replay.active = 0;
+    napi_call_threadsafe_function(tsfn, delivered, napi_tsfn_blocking);
+    napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+    return NULL;
+}
+
+// Fin du rejeu appelée depuis le thread JavaScript
+static void call_js_replay(napi_env env, napi_value js_callback, void* context, void* data) {
+    if (env != NULL) {
+        napi_value result;
+        napi_create_double(env, data ? (double)*(uint64_t*)data : 0, &result);
+        napi_resolve_deferred(env, (napi_deferred)context, result);
+    }
+    free(data);
+}
+
+// Attendre la fin du thread de rejeu précédent
+static void replay_join(void) {
+    if (replay.running) {
+        replay.active = 0;
+        pthread_join(replay.thread, NULL);
+        replay.running = 0;
+    }
+}
+
+// Fonction: replayStart(path, realtime, speed) - Promise du nombre d'événements transmis
+static napi_value ReplayStart(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    char path[256];
+    bool realtime = true;
+    double speed = 1.0;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 1 ||
+        napi_get_value_string_utf8(env, args[0], path, sizeof(path), NULL) != napi_ok) {
+        napi_throw_error(env, NULL, "Expected path argument");
+        return NULL;
+    }
+    if (argc >= 2) napi_get_value_bool(env, args[1], &realtime);
+    if (argc >= 3) napi_get_value_double(env, args[2], &speed);
+    if (!(speed > 0)) {
+        napi_throw_error(env, NULL, "Invalid replay speed");
+        return NULL;
+    }
+
+    if (replay.active) {
+        napi_throw_error(env, NULL, "Replay already started");
+        return NULL;
+    }
+    replay_join();
+
+    // Projeter et vérifier l'enregistrement
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        napi_throw_error(env, NULL, "Failed to open record file");
+        return NULL;
+    }
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(record_header_t)) {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    record_header_t *header = (record_header_t*)map;
+    if (map == MAP_FAILED || memcmp(header->magic, RECORD_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != RECORD_VERSION ||
+        sizeof(record_header_t) + header->count * sizeof(record_event_t) > (size_t)st.st_size) {
+        if (map != MAP_FAILED) munmap(map, st.st_size);
+        napi_throw_error(env, NULL, "Invalid record file");
+        return NULL;
     }
 
+    napi_value promise, async_resource_name;
+    napi_deferred deferred;
+    napi_create_promise(env, &deferred, &promise);
+    napi_create_string_utf8(env, "GPIOReplay", NAPI_AUTO_LENGTH, &async_resource_name);
+
+    status = napi_create_threadsafe_function(env, NULL, NULL, async_resource_name,
+        0, 1, NULL, NULL, deferred, call_js_replay, &replay.tsfn);
+    if (status != napi_ok) {
+        munmap(map, st.st_size);
+        napi_value message, error;
+        napi_create_string_utf8(env, "Failed to create threadsafe function", NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, NULL, message, &error);
+        napi_reject_deferred(env, deferred, error);
+        return promise;
+    }
+
+    replay.map = (uint8_t*)map;
+    replay.size = st.st_size;
+    replay.realtime = realtime;
+    replay.speed = speed;
+    replay.delivered = 0;
+    replay.active = 1;
+    if (pthread_create(&replay.thread, NULL, replay_thread_func, NULL) != 0) {
+        replay.active = 0;
+        munmap(map, st.st_size);
+        replay.map = NULL;
+        napi_release_threadsafe_function(replay.tsfn, napi_tsfn_abort);
+        replay.tsfn = NULL;
+        napi_value message, error;
+        napi_create_string_utf8(env, "Failed to create replay thread", NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, NULL, message, &error);
+        napi_reject_deferred(env, deferred, error);
+        return promise;
+    }
+    replay.running = 1;
+
+    return promise;
+}
+
+// Fonction: replayStop() - la promesse du rejeu est résolue avec les événements déjà transmis
+static napi_value ReplayStop(napi_env env, napi_callback_info info) {
+    replay_join();
+
     napi_value result;
     napi_get_undefined(env, &result);
     return result;
@@ -663,7 +1826,7 @@ static napi_value Write(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
-    if (ctx->is_closed) {
+    if (ctx->is_closed || ctx->is_closing) {
         napi_throw_error(env, NULL, "GPIO handle has been closed");
         return NULL;
     }
@@ -715,25 +1878,28 @@ static napi_value Read(napi_env env, napi_callback_info info) {
         return NULL;
     }
 
-    if (ctx->is_closed) {
+    if (ctx->is_closed || ctx->is_closing) {
         napi_throw_error(env, NULL, "GPIO handle has been closed");
         return NULL;
     }
 
+    int value = ctx->value;
+    if (!ctx->is_virtual) {
 #ifdef LIBGPIOD_V2
-    enum gpiod_line_value gpio_value = gpiod_line_request_get_value(ctx->request, ctx->offset);
-    if (gpio_value == GPIOD_LINE_VALUE_ERROR) {
-        napi_throw_error(env, NULL, "Failed to read GPIO value (v2)");
-        return NULL;
-    }
-    int value = (gpio_value == GPIOD_LINE_VALUE_ACTIVE) ? 1 : 0;
+        enum gpiod_line_value gpio_value = gpiod_line_request_get_value(ctx->request, ctx->offset);
+        if (gpio_value == GPIOD_LINE_VALUE_ERROR) {
+            napi_throw_error(env, NULL, "Failed to read GPIO value (v2)");
+            return NULL;
+        }
+        value = (gpio_value == GPIOD_LINE_VALUE_ACTIVE) ? 1 : 0;
 #else
-    int value = gpiod_line_get_value(ctx->line);
-    if (value < 0) {
-        napi_throw_error(env, NULL, "Failed to read GPIO value (v1)");
-        return NULL;
-    }
+        value = gpiod_line_get_value(ctx->line);
+        if (value < 0) {
+            napi_throw_error(env, NULL, "Failed to read GPIO value (v1)");
+            return NULL;
+        }
 #endif
+    }
 
     napi_value result;
     status = napi_create_int32(env, value, &result);
@@ -745,79 +1911,2770 @@ static napi_value Read(napi_env env, napi_callback_info info) {
     return result;
 }
 
-// Fonction: close(handle)
-static napi_value Close(napi_env env, napi_callback_info info) {
-    napi_status status;
-    size_t argc = 1;
-    napi_value args[1];
-    gpio_context_t *ctx = NULL;
+// Mesure d'impulsion, appelée avec les verrous de trig et echo
+static int64_t pulse_measure_locked(gpio_context_t *trig, gpio_context_t *echo, int pulse_us, int timeout_ms) {
+    int64_t width = PULSE_TIMEOUT;
+    uint64_t rising = 0;
 
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    if (status != napi_ok || argc < 1) {
-        napi_throw_error(env, NULL, "Expected handle argument");
-        return NULL;
-    }
+    // Vider les événements en attente sur l'écho
+#ifdef LIBGPIOD_V2
+    struct gpiod_edge_event_buffer *event_buffer = gpiod_edge_event_buffer_new(GPIO_EVENT_BATCH);
+    if (!event_buffer) return PULSE_ERROR;
 
-    status = napi_get_value_external(env, args[0], (void**)&ctx);
-    if (status != napi_ok || ctx == NULL) {
-        napi_value result;
-        napi_get_undefined(env, &result);
-        return result;
+    while (gpiod_line_request_wait_edge_events(echo->request, 0) > 0) {
+        if (gpiod_line_request_read_edge_events(echo->request, event_buffer, GPIO_EVENT_BATCH) <= 0) break;
     }
+#else
+    struct gpiod_line_event events[GPIO_EVENT_BATCH];
+    struct timespec zero = {0, 0};
 
-    if (ctx->is_closed) {
-        napi_value result;
-        napi_get_undefined(env, &result);
-        return result;
+    while (gpiod_line_event_wait(echo->line, &zero) > 0) {
+        if (gpiod_line_event_read_multiple(echo->line, events, GPIO_EVENT_BATCH) <= 0) break;
     }
+#endif
 
-    // Arrêter le monitoring si actif
-    if (ctx->is_monitoring) {
-        ctx->is_monitoring = 0;
-        if (ctx->monitor_thread) {
-            pthread_join(ctx->monitor_thread, NULL);
-            ctx->monitor_thread = 0;
+    // Impulsion de déclenchement: attente active, un sleep serait trop imprécis à 10µs
+    if (set_line_value(trig, 1) < 0) {
+        width = PULSE_ERROR;
+    } else {
+        uint64_t pulse_end = monotonic_ns() + (uint64_t)pulse_us * 1000ULL;
+        while (monotonic_ns() < pulse_end) {
+        }
+        if (set_line_value(trig, 0) < 0) {
+            width = PULSE_ERROR;
+        }
+    }
+
+    // Largeur de l'impulsion haute d'après les horodatages noyau des fronts
+    uint64_t deadline = monotonic_ns() + (uint64_t)timeout_ms * 1000000ULL;
+    while (width == PULSE_TIMEOUT) {
+        uint64_t now = monotonic_ns();
+        if (now >= deadline) break;
+
+#ifdef LIBGPIOD_V2
+        int ret = gpiod_line_request_wait_edge_events(echo->request, (int64_t)(deadline - now));
+        if (ret == 0) break;
+        if (ret > 0) {
+            ret = gpiod_line_request_read_edge_events(echo->request, event_buffer, GPIO_EVENT_BATCH);
+        }
+        if (ret < 0) {
+            width = PULSE_ERROR;
+            break;
+        }
+        for (int i = 0; i < ret && width == PULSE_TIMEOUT; i++) {
+            struct gpiod_edge_event *event = gpiod_edge_event_buffer_get_event(event_buffer, i);
+            if (!event) continue;
+            uint64_t timestamp = gpiod_edge_event_get_timestamp_ns(event);
+            if (gpiod_edge_event_get_event_type(event) == GPIOD_EDGE_EVENT_RISING_EDGE) {
+                rising = timestamp;
+            } else if (rising) {
+                width = (int64_t)(timestamp - rising);
+            }
+        }
+#else
+        struct timespec timeout;
+        timeout.tv_sec = (deadline - now) / 1000000000ULL;
+        timeout.tv_nsec = (deadline - now) % 1000000000ULL;
+        int ret = gpiod_line_event_wait(echo->line, &timeout);
+        if (ret == 0) break;
+        if (ret > 0) {
+            ret = gpiod_line_event_read_multiple(echo->line, events, GPIO_EVENT_BATCH);
+        }
+        if (ret < 0) {
+            width = PULSE_ERROR;
+            break;
+        }
+        for (int i = 0; i < ret && width == PULSE_TIMEOUT; i++) {
+            uint64_t timestamp = (uint64_t)events[i].ts.tv_sec * 1000000000ULL + (uint64_t)events[i].ts.tv_nsec;
+            if (events[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE) {
+                rising = timestamp;
+            } else if (rising) {
+                width = (int64_t)(timestamp - rising);
+            }
+        }
+#endif
+    }
+
+#ifdef LIBGPIOD_V2
+    gpiod_edge_event_buffer_free(event_buffer);
+#endif
+    return width;
+}
+
+// Déclencher une impulsion sur trig puis mesurer la largeur de l'écho (ns)
+// Retourne PULSE_TIMEOUT sans écho complet avant timeout, PULSE_ERROR si erreur
+static int64_t pulse_measure(gpio_context_t *trig, gpio_context_t *echo, int pulse_us, int timeout_ms) {
+    int64_t width = PULSE_ERROR;
+
+    pthread_mutex_lock(&trig->lock);
+    pthread_mutex_lock(&echo->lock);
+    if (!trig->is_closed && !echo->is_closed) {
+        width = pulse_measure_locked(trig, echo, pulse_us, timeout_ms);
+    }
+    pthread_mutex_unlock(&echo->lock);
+    pthread_mutex_unlock(&trig->lock);
+
+    return width;
+}
+
+// Lire et vérifier les arguments (trigger, echo, pulseUs, timeoutMs) communs aux mesures
+static int get_pulse_args(napi_env env, napi_value *args, size_t argc,
+                          gpio_context_t **trig, gpio_context_t **echo, int *pulse_us, int *timeout_ms) {
+    if (argc < 4) {
+        napi_throw_error(env, NULL, "Expected trigger, echo, pulseUs and timeoutMs arguments");
+        return -1;
+    }
+
+    if (napi_get_value_external(env, args[0], (void**)trig) != napi_ok || *trig == NULL ||
+        napi_get_value_external(env, args[1], (void**)echo) != napi_ok || *echo == NULL) {
+        napi_throw_error(env, NULL, "Invalid GPIO handle");
+        return -1;
+    }
+
+    if ((*trig)->is_closed || (*trig)->is_closing || (*echo)->is_closed || (*echo)->is_closing) {
+        napi_throw_error(env, NULL, "GPIO handle has been closed");
+        return -1;
+    }
+
+    if ((*trig)->is_virtual || (*echo)->is_virtual) {
+        napi_throw_error(env, NULL, "Cannot measure pulse on a replay GPIO");
+        return -1;
+    }
+
+    if (!(*trig)->is_output || (*echo)->is_output) {
+        napi_throw_error(env, NULL, "Trigger must be an output and echo an input");
+        return -1;
+    }
+
+    if ((*echo)->is_monitoring) {
+        napi_throw_error(env, NULL, "Cannot measure pulse on a monitored GPIO");
+        return -1;
+    }
+
+    if (napi_get_value_int32(env, args[2], pulse_us) != napi_ok ||
+        napi_get_value_int32(env, args[3], timeout_ms) != napi_ok) {
+        napi_throw_error(env, NULL, "Invalid pulse or timeout value");
+        return -1;
+    }
+
+    if (*pulse_us < 1 || *pulse_us > PULSE_MAX_US || *timeout_ms < 1) {
+        napi_throw_error(env, NULL, "Pulse or timeout value out of range");
+        return -1;
+    }
+
+    return 0;
+}
+
+// Fonction: pulseMeasure(trigger, echo, pulseUs, timeoutMs) - largeur en ns, -1 si timeout
+static napi_value PulseMeasure(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    gpio_context_t *trig = NULL, *echo = NULL;
+    int pulse_us, timeout_ms;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (get_pulse_args(env, args, argc, &trig, &echo, &pulse_us, &timeout_ms) < 0) {
+        return NULL;
+    }
+
+    int64_t width = pulse_measure(trig, echo, pulse_us, timeout_ms);
+    if (width == PULSE_ERROR) {
+        napi_throw_error(env, NULL, "Failed to measure pulse");
+        return NULL;
+    }
+
+    napi_value result;
+    napi_create_int64(env, width, &result);
+    return result;
+}
+
+// Données de la mesure asynchrone
+typedef struct {
+    napi_async_work work;
+    napi_deferred deferred;
+    napi_ref trig_ref;
+    napi_ref echo_ref;
+    gpio_context_t *trig;
+    gpio_context_t *echo;
+    int pulse_us;
+    int timeout_ms;
+    int64_t width;
+} pulse_work_t;
+
+static void pulse_work_execute(napi_env env, void* data) {
+    pulse_work_t *pw = (pulse_work_t*)data;
+    pw->width = pulse_measure(pw->trig, pw->echo, pw->pulse_us, pw->timeout_ms);
+}
+
+static void pulse_work_complete(napi_env env, napi_status status, void* data) {
+    pulse_work_t *pw = (pulse_work_t*)data;
+    napi_value result;
+
+    if (status != napi_ok || pw->width == PULSE_ERROR) {
+        napi_value message;
+        napi_create_string_utf8(env, "Failed to measure pulse", NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, NULL, message, &result);
+        napi_reject_deferred(env, pw->deferred, result);
+    } else {
+        napi_create_int64(env, pw->width, &result);
+        napi_resolve_deferred(env, pw->deferred, result);
+    }
+
+    pw->echo->pulse_pending--;
+    napi_delete_reference(env, pw->trig_ref);
+    napi_delete_reference(env, pw->echo_ref);
+    napi_delete_async_work(env, pw->work);
+    free(pw);
+}
+
+// Fonction: pulseMeasureAsync(trigger, echo, pulseUs, timeoutMs) - Promise de la largeur en ns
+static napi_value PulseMeasureAsync(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    gpio_context_t *trig = NULL, *echo = NULL;
+    int pulse_us, timeout_ms;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (get_pulse_args(env, args, argc, &trig, &echo, &pulse_us, &timeout_ms) < 0) {
+        return NULL;
+    }
+
+    pulse_work_t *pw = (pulse_work_t*)malloc(sizeof(pulse_work_t));
+    if (!pw) {
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+    memset(pw, 0, sizeof(pulse_work_t));
+    pw->trig = trig;
+    pw->echo = echo;
+    pw->pulse_us = pulse_us;
+    pw->timeout_ms = timeout_ms;
+
+    // Garder les handles en vie pendant la mesure
+    napi_create_reference(env, args[0], 1, &pw->trig_ref);
+    napi_create_reference(env, args[1], 1, &pw->echo_ref);
+
+    napi_value promise, resource_name;
+    napi_create_promise(env, &pw->deferred, &promise);
+    napi_create_string_utf8(env, "GPIOPulseMeasure", NAPI_AUTO_LENGTH, &resource_name);
+
+    napi_status status = napi_create_async_work(env, NULL, resource_name,
+        pulse_work_execute, pulse_work_complete, pw, &pw->work);
+    if (status == napi_ok) {
+        status = napi_queue_async_work(env, pw->work);
+    }
+    if (status == napi_ok) {
+        echo->pulse_pending++;
+    }
+
+    if (status != napi_ok) {
+        napi_value message, error;
+        napi_create_string_utf8(env, "Failed to queue pulse measurement", NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, NULL, message, &error);
+        napi_reject_deferred(env, pw->deferred, error);
+        if (pw->work) napi_delete_async_work(env, pw->work);
+        napi_delete_reference(env, pw->trig_ref);
+        napi_delete_reference(env, pw->echo_ref);
+        free(pw);
+    }
+
+    return promise;
+}
+
+// Thread de mesure continue: une mesure par intervalle
+static void* ranging_thread_func(void* arg) {
+    gpio_context_t *ctx = (gpio_context_t*)arg;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (ctx->is_ranging && !ctx->is_closed) {
+        int64_t width = pulse_measure(ctx->ranging_trigger, ctx,
+                                      ctx->ranging_pulse_us, ctx->ranging_timeout_ms);
+
+        int64_t *data = (int64_t*)malloc(sizeof(int64_t));
+        if (data) {
+            *data = width;
+            napi_call_threadsafe_function(ctx->ranging_tsfn, data, napi_tsfn_blocking);
+        }
+
+        // Ligne fermée ou en erreur: inutile de continuer
+        if (width == PULSE_ERROR) break;
+
+        // Prochaine mesure à intervalle fixe, sans rattrapage en cas de retard
+        next.tv_sec += ctx->ranging_interval_ms / 1000;
+        next.tv_nsec += (long)(ctx->ranging_interval_ms % 1000) * 1000000L;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        uint64_t next_ns = (uint64_t)next.tv_sec * 1000000000ULL + (uint64_t)next.tv_nsec;
+        if (next_ns < monotonic_ns()) {
+            clock_gettime(CLOCK_MONOTONIC, &next);
+        } else if (wait_until(ctx, &next)) {
+            break; // réveil par stopRanging/close
+        }
+    }
+
+    return NULL;
+}
+
+// Callback de mesure continue appelé depuis le thread JavaScript: callback(width)
+static void call_js_ranging(napi_env env, napi_value js_callback, void* context, void* data) {
+    if (data == NULL) {
+        return;
+    }
+
+    int64_t *width = (int64_t*)data;
+
+    if (env != NULL && js_callback != NULL) {
+        napi_value argv[1];
+        napi_status status = napi_create_int64(env, *width, &argv[0]);
+
+        if (status == napi_ok) {
+            napi_value global;
+            status = napi_get_global(env, &global);
+
+            if (status == napi_ok) {
+                napi_value result;
+                napi_call_function(env, global, js_callback, 1, argv, &result);
+            }
+        }
+    }
+
+    free(data);
+}
+
+// Fonction: startRanging(trigger, echo, pulseUs, timeoutMs, intervalMs, callback)
+static napi_value StartRanging(napi_env env, napi_callback_info info) {
+    size_t argc = 6;
+    napi_value args[6];
+    gpio_context_t *trig = NULL, *echo = NULL;
+    int pulse_us, timeout_ms, interval_ms;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (get_pulse_args(env, args, argc, &trig, &echo, &pulse_us, &timeout_ms) < 0) {
+        return NULL;
+    }
+
+    if (argc < 6 || napi_get_value_int32(env, args[4], &interval_ms) != napi_ok || interval_ms < 1) {
+        napi_throw_error(env, NULL, "Expected valid intervalMs and callback arguments");
+        return NULL;
+    }
+
+    if (echo->is_ranging) {
+        napi_throw_error(env, NULL, "Ranging already started");
+        return NULL;
+    }
+
+    napi_value async_resource_name;
+    napi_create_string_utf8(env, "GPIORanging", NAPI_AUTO_LENGTH, &async_resource_name);
+
+    napi_status status = napi_create_threadsafe_function(
+        env,
+        args[5],
+        NULL,
+        async_resource_name,
+        0,
+        1,
+        NULL,
+        NULL,
+        echo,
+        call_js_ranging,
+        &echo->ranging_tsfn
+    );
+
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Failed to create threadsafe function");
+        return NULL;
+    }
+
+    if (napi_create_reference(env, args[0], 1, &echo->ranging_trigger_ref) != napi_ok) {
+        napi_release_threadsafe_function(echo->ranging_tsfn, napi_tsfn_release);
+        echo->ranging_tsfn = NULL;
+        napi_throw_error(env, NULL, "Failed to reference trigger GPIO");
+        return NULL;
+    }
+    echo->ranging_trigger = trig;
+    echo->ranging_pulse_us = pulse_us;
+    echo->ranging_timeout_ms = timeout_ms;
+    echo->ranging_interval_ms = interval_ms;
+
+    // Démarrer le thread de mesure continue
+    wake_reset(echo);
+    echo->is_ranging = 1;
+    if (pthread_create(&echo->ranging_thread, NULL, ranging_thread_func, echo) != 0) {
+        echo->is_ranging = 0;
+        echo->ranging_thread = 0;
+        napi_release_threadsafe_function(echo->ranging_tsfn, napi_tsfn_release);
+        echo->ranging_tsfn = NULL;
+        echo->ranging_trigger = NULL;
+        ranging_unref(env, echo);
+        napi_throw_error(env, NULL, "Failed to create ranging thread");
+        return NULL;
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fonction: stopRanging(echo)
+static napi_value StopRanging(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    gpio_context_t *ctx = NULL;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected handle argument");
+        return NULL;
+    }
+
+    // closeAsync() en cours: le thread est déjà arrêté par close_execute
+    status = napi_get_value_external(env, args[0], (void**)&ctx);
+    if (status == napi_ok && ctx != NULL && !ctx->is_closing) {
+        stop_ranging(env, ctx);
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fonction: close(handle)
+static napi_value Close(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value args[1];
+    gpio_context_t *ctx = NULL;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected handle argument");
+        return NULL;
+    }
+
+    status = napi_get_value_external(env, args[0], (void**)&ctx);
+    if (status != napi_ok || ctx == NULL) {
+        napi_value result;
+        napi_get_undefined(env, &result);
+        return result;
+    }
+
+    if (ctx->is_closed || ctx->is_closing) {
+        napi_value result;
+        napi_get_undefined(env, &result);
+        return result;
+    }
+
+    // Retirer les règles réflexes de la ligne puis arrêter le monitoring si actif
+    reflex_remove_ctx(env, ctx);
+    stop_monitoring(env, ctx);
+
+    // Arrêter la mesure continue si active puis attendre une mesure en cours
+    stop_ranging(env, ctx);
+    pthread_mutex_lock(&ctx->lock);
+    release_line(ctx);
+    pthread_mutex_unlock(&ctx->lock);
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fermeture asynchrone: attente des threads et libération hors du thread JavaScript
+typedef struct {
+    napi_async_work work;
+    napi_deferred deferred;
+    napi_ref handle_ref; // garde le contexte en vie jusqu'à la fin
+    gpio_context_t *ctx;
+} close_work_t;
+
+static void close_execute(napi_env env, void *data) {
+    close_work_t *w = (close_work_t*)data;
+    gpio_context_t *ctx = w->ctx;
+
+    monitoring_join(ctx);
+    ranging_join(ctx);
+    pthread_mutex_lock(&ctx->lock);
+    release_line(ctx);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+static void close_complete(napi_env env, napi_status status, void *data) {
+    close_work_t *w = (close_work_t*)data;
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    napi_resolve_deferred(env, w->deferred, result);
+
+    ranging_unref(env, w->ctx);
+    napi_delete_reference(env, w->handle_ref);
+    napi_delete_async_work(env, w->work);
+    free(w);
+}
+
+// Fonction: closeAsync(handle) - Promise résolue quand la ligne est libérée
+static napi_value CloseAsync(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    gpio_context_t *ctx = NULL;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected handle argument");
+        return NULL;
+    }
+
+    napi_value promise;
+    napi_deferred deferred;
+    napi_create_promise(env, &deferred, &promise);
+
+    status = napi_get_value_external(env, args[0], (void**)&ctx);
+    if (status != napi_ok || ctx == NULL || ctx->is_closed || ctx->is_closing) {
+        napi_value result;
+        napi_get_undefined(env, &result);
+        napi_resolve_deferred(env, deferred, result);
+        return promise;
+    }
+
+    close_work_t *w = (close_work_t*)calloc(1, sizeof(close_work_t));
+    if (!w) {
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+    w->ctx = ctx;
+    w->deferred = deferred;
+    ctx->is_closing = 1;
+    reflex_remove_ctx(env, ctx);
+
+    // Réveiller les threads tout de suite, l'attente se fait dans le pool de libuv
+    monitoring_signal(env, ctx);
+    ranging_signal(ctx);
+
+    napi_value resource_name;
+    napi_create_string_utf8(env, "GPIOClose", NAPI_AUTO_LENGTH, &resource_name);
+    napi_create_reference(env, args[0], 1, &w->handle_ref);
+    status = napi_create_async_work(env, NULL, resource_name, close_execute, close_complete, w, &w->work);
+    if (status == napi_ok) {
+        status = napi_queue_async_work(env, w->work);
+    }
+    if (status != napi_ok) {
+        // Repli synchrone: les threads sont déjà réveillés
+        close_execute(env, w);
+        if (w->work) napi_delete_async_work(env, w->work);
+        w->work = NULL;
+        napi_delete_reference(env, w->handle_ref);
+        napi_value result;
+        napi_get_undefined(env, &result);
+        napi_resolve_deferred(env, deferred, result);
+        free(w);
+    }
+
+    return promise;
+}
+
+// Callback appelé depuis le thread JavaScript: callback(edge, timestamp, actionTime)
+static void call_js_reflex(napi_env env, napi_value js_callback, void* context, void* data) {
+    if (data == NULL) {
+        return;
+    }
+
+    reflex_event_t *event = (reflex_event_t*)data;
+
+    if (env != NULL && js_callback != NULL) {
+        napi_value argv[3];
+        napi_status status = napi_create_int32(env, event->edge, &argv[0]);
+
+        if (status == napi_ok) {
+            status = napi_create_bigint_uint64(env, event->timestamp_ns, &argv[1]);
+        }
+
+        if (status == napi_ok) {
+            status = napi_create_bigint_uint64(env, event->action_ns, &argv[2]);
+        }
+
+        if (status == napi_ok) {
+            napi_value global;
+            status = napi_get_global(env, &global);
+
+            if (status == napi_ok) {
+                napi_value result;
+                napi_call_function(env, global, js_callback, 3, argv, &result);
+            }
+        }
+    }
+
+    free(data);
+}
+
+// Fonction: reflexAdd(inputHandle, outputHandle, edge, value, latch, delayUs, callback) - Retourne l'id de la règle
+static napi_value ReflexAdd(napi_env env, napi_callback_info info) {
+    size_t argc = 7;
+    napi_value args[7];
+    gpio_context_t *input = NULL;
+    gpio_context_t *output = NULL;
+    int edge, value;
+    bool latch;
+    int64_t delay_us;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 6) {
+        napi_throw_error(env, NULL, "Expected input, output, edge, value, latch and delay arguments");
+        return NULL;
+    }
+
+    status = napi_get_value_external(env, args[0], (void**)&input);
+    if (status != napi_ok || input == NULL) {
+        napi_throw_error(env, NULL, "Invalid input GPIO handle");
+        return NULL;
+    }
+
+    status = napi_get_value_external(env, args[1], (void**)&output);
+    if (status != napi_ok || output == NULL) {
+        napi_throw_error(env, NULL, "Invalid output GPIO handle");
+        return NULL;
+    }
+
+    if (input->is_closed || input->is_closing || output->is_closed || output->is_closing) {
+        napi_throw_error(env, NULL, "GPIO handle has been closed");
+        return NULL;
+    }
+
+    if (input->is_output) {
+        napi_throw_error(env, NULL, "Reflex input must be an input GPIO");
+        return NULL;
+    }
+
+    if (!output->is_output) {
+        napi_throw_error(env, NULL, "Reflex output must be an output GPIO");
+        return NULL;
+    }
+
+    if (input->is_ranging) {
+        napi_throw_error(env, NULL, "Cannot add reflex on GPIO while ranging");
+        return NULL;
+    }
+
+    if (input->pulse_pending) {
+        napi_throw_error(env, NULL, "Cannot add reflex on GPIO during pulse measurement");
+        return NULL;
+    }
+
+    if (napi_get_value_int32(env, args[2], &edge) != napi_ok
+        || napi_get_value_int32(env, args[3], &value) != napi_ok
+        || napi_get_value_bool(env, args[4], &latch) != napi_ok
+        || napi_get_value_int64(env, args[5], &delay_us) != napi_ok) {
+        napi_throw_error(env, NULL, "Invalid reflex arguments");
+        return NULL;
+    }
+
+    if (edge < REFLEX_FALLING || edge > REFLEX_BOTH || delay_us < 0) {
+        napi_throw_error(env, NULL, "Invalid reflex edge or delay");
+        return NULL;
+    }
+
+    reflex_rule_t *rule = (reflex_rule_t*)calloc(1, sizeof(reflex_rule_t));
+    if (!rule) {
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+    rule->input = input;
+    rule->output = output;
+    rule->edge = edge;
+    rule->value = value ? 1 : 0;
+    rule->latch = latch ? 1 : 0;
+    rule->delay_ns = (uint64_t)delay_us * 1000ULL;
+
+    // Notification JavaScript facultative
+    napi_valuetype type = napi_undefined;
+    if (argc > 6) {
+        napi_typeof(env, args[6], &type);
+    }
+    if (type == napi_function) {
+        napi_value resource_name;
+        napi_create_string_utf8(env, "GPIOReflex", NAPI_AUTO_LENGTH, &resource_name);
+        status = napi_create_threadsafe_function(env, args[6], NULL, resource_name, 0, 1,
+            NULL, NULL, NULL, call_js_reflex, &rule->tsfn);
+        if (status != napi_ok) {
+            free(rule);
+            napi_throw_error(env, NULL, "Failed to create threadsafe function");
+            return NULL;
+        }
+    }
+
+    // Démarrer le thread des actions différées à la première règle qui en a besoin
+    pthread_mutex_lock(&reflex.lock);
+    if (rule->delay_ns && !reflex.running) {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&reflex.cond, &attr);
+        pthread_condattr_destroy(&attr);
+
+        reflex.running = 1;
+        if (pthread_create(&reflex.thread, NULL, reflex_thread_func, NULL) != 0) {
+            reflex.running = 0;
+            pthread_cond_destroy(&reflex.cond);
+            pthread_mutex_unlock(&reflex.lock);
+            if (rule->tsfn) napi_release_threadsafe_function(rule->tsfn, napi_tsfn_release);
+            free(rule);
+            napi_throw_error(env, NULL, "Failed to create reflex thread");
+            return NULL;
+        }
+    }
+
+    napi_create_reference(env, args[0], 1, &rule->input_ref);
+    napi_create_reference(env, args[1], 1, &rule->output_ref);
+    rule->id = ++reflex.next_id;
+    rule->next = reflex.rules;
+    reflex.rules = rule;
+    __atomic_add_fetch(&input->reflex_count, 1, __ATOMIC_RELEASE);
+    int id = rule->id;
+    pthread_mutex_unlock(&reflex.lock);
+
+    // Le thread d'événements de l'entrée exécute la règle, même sans monitoring JavaScript
+    if (!input->is_monitoring && event_thread_start(input) < 0) {
+        pthread_mutex_lock(&reflex.lock);
+        reflex_unlink(env, rule);
+        pthread_mutex_unlock(&reflex.lock);
+        reflex_thread_stop_if_idle();
+        napi_throw_error(env, NULL, "Failed to create monitor thread");
+        return NULL;
+    }
+
+    napi_value result;
+    napi_create_int32(env, id, &result);
+    return result;
+}
+
+// Trouver une règle par son id, appelé avec le verrou des réflexes
+static reflex_rule_t* reflex_find(int id) {
+    for (reflex_rule_t *rule = reflex.rules; rule; rule = rule->next) {
+        if (rule->id == id) return rule;
+    }
+    return NULL;
+}
+
+// Fonction: reflexRemove(id) - Retourne false si la règle n'existe pas
+static napi_value ReflexRemove(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    int id;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 1 || napi_get_value_int32(env, args[0], &id) != napi_ok) {
+        napi_throw_error(env, NULL, "Expected reflex id argument");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&reflex.lock);
+    reflex_rule_t *rule = reflex_find(id);
+    if (rule) {
+        reflex_unlink(env, rule);
+    }
+    pthread_mutex_unlock(&reflex.lock);
+
+    if (rule) {
+        reflex_thread_stop_if_idle();
+        reflex_stop_idle_inputs(env, NULL);
+    }
+
+    napi_value result;
+    napi_get_boolean(env, rule != NULL, &result);
+    return result;
+}
+
+// Fonction: reflexReset(id) - Réarmer une règle à exécution unique, retourne false si elle n'existe pas
+static napi_value ReflexReset(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    int id;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 1 || napi_get_value_int32(env, args[0], &id) != napi_ok) {
+        napi_throw_error(env, NULL, "Expected reflex id argument");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&reflex.lock);
+    reflex_rule_t *rule = reflex_find(id);
+    if (rule) {
+        rule->fired = 0;
+    }
+    pthread_mutex_unlock(&reflex.lock);
+
+    napi_value result;
+    napi_get_boolean(env, rule != NULL, &result);
+    return result;
+}
+
+// Mouvement PWM: rampe commune aux canaux déplacés ensemble
+typedef struct {
+    napi_threadsafe_function tsfn;
+    napi_deferred deferred;
+    int pending;        // canaux encore en mouvement
+    int cancelled;
+    int profile;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint64_t period_ns;
+    uint64_t next_tick_ns;
+} pwm_motion_t;
+
+// Canal PWM (fichier duty_cycle du sysfs gardé ouvert)
+typedef struct pwm_channel {
+    int fd;
+    int is_closed;
+    int64_t duty_ns;    // dernière valeur écrite
+    int64_t from_ns;
+    int64_t to_ns;
+    pwm_motion_t *motion;
+    struct pwm_channel *next;
+} pwm_channel_t;
+
+// Moteur de mouvement: un thread pour tous les canaux ouverts
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    int running;
+    pwm_channel_t *channels;
+} pwm_engine = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// Écrire le duty cycle (ns) dans le sysfs
+static int pwm_write_duty(pwm_channel_t *ch, int64_t duty_ns) {
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%lld", (long long)duty_ns);
+    if (pwrite(ch->fd, buf, len, 0) != len) {
+        return -1;
+    }
+    ch->duty_ns = duty_ns;
+    return 0;
+}
+
+// Position normalisée [0, 1] selon le profil pour t dans [0, 1]
+static double pwm_profile_position(int profile, double t) {
+    switch (profile) {
+        case PWM_PROFILE_TRAPEZOIDAL: {
+            double f = PWM_TRAPEZOID_RAMP;
+            double v = 1.0 / (1.0 - f);
+            if (t < f) return v * t * t / (2.0 * f);
+            if (t < 1.0 - f) return v * (t - f / 2.0);
+            return 1.0 - v * (1.0 - t) * (1.0 - t) / (2.0 * f);
+        }
+        case PWM_PROFILE_SCURVE:
+            // Polynôme à jerk minimal: vitesse et accélération nulles aux extrémités
+            return t * t * t * (10.0 - 15.0 * t + 6.0 * t * t);
+        default:
+            return t;
+    }
+}
+
+// Détacher un canal de son mouvement, résoudre la promesse si c'était le dernier
+// Appelé avec le verrou du moteur
+static void pwm_motion_detach(pwm_channel_t *ch, int cancelled) {
+    pwm_motion_t *motion = ch->motion;
+    if (!motion) return;
+
+    ch->motion = NULL;
+    if (cancelled) motion->cancelled = 1;
+    if (--motion->pending == 0) {
+        // Le mouvement est libéré par le thread JavaScript dès l'appel, ici si
+        // l'appel est refusé (environnement en cours de fermeture)
+        napi_threadsafe_function tsfn = motion->tsfn;
+        if (napi_call_threadsafe_function(tsfn, motion, napi_tsfn_nonblocking) != napi_ok) {
+            free(motion);
+        }
+        napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+    }
+}
+
+// Thread du moteur: mettre à jour les canaux en mouvement à la fréquence de chaque mouvement
+static void* pwm_engine_thread_func(void* arg) {
+    pthread_mutex_lock(&pwm_engine.lock);
+
+    while (pwm_engine.running) {
+        uint64_t now = monotonic_ns();
+        uint64_t wake = 0;
+
+        for (pwm_channel_t *ch = pwm_engine.channels; ch; ch = ch->next) {
+            pwm_motion_t *motion = ch->motion;
+            if (!motion || motion->next_tick_ns > now) continue;
+
+            double t = motion->duration_ns ? (double)(now - motion->start_ns) / (double)motion->duration_ns : 1.0;
+            if (t >= 1.0) {
+                if (ch->duty_ns != ch->to_ns) pwm_write_duty(ch, ch->to_ns);
+                pwm_motion_detach(ch, 0);
+                continue;
+            }
+
+            int64_t duty = ch->from_ns + llround((double)(ch->to_ns - ch->from_ns) * pwm_profile_position(motion->profile, t));
+            if (duty != ch->duty_ns) pwm_write_duty(ch, duty);
+        }
+
+        // Prochain pas: tous les canaux d'un mouvement partagent le même pas
+        for (pwm_channel_t *ch = pwm_engine.channels; ch; ch = ch->next) {
+            pwm_motion_t *motion = ch->motion;
+            if (!motion) continue;
+            if (motion->next_tick_ns <= now) {
+                motion->next_tick_ns += motion->period_ns;
+                if (motion->next_tick_ns <= now) motion->next_tick_ns = now + motion->period_ns;
+            }
+            if (!wake || motion->next_tick_ns < wake) wake = motion->next_tick_ns;
+        }
+
+        if (!wake) {
+            pthread_cond_wait(&pwm_engine.cond, &pwm_engine.lock);
+        } else {
+            struct timespec ts;
+            ts.tv_sec = wake / 1000000000ULL;
+            ts.tv_nsec = wake % 1000000000ULL;
+            pthread_cond_timedwait(&pwm_engine.cond, &pwm_engine.lock, &ts);
+        }
+    }
+
+    pthread_mutex_unlock(&pwm_engine.lock);
+    return NULL;
+}
+
+// Fermer un canal: annuler son mouvement et arrêter le moteur s'il n'y a plus de canal
+static void pwm_channel_close(pwm_channel_t *ch) {
+    pthread_t thread = 0;
+
+    pthread_mutex_lock(&pwm_engine.lock);
+    if (ch->is_closed) {
+        pthread_mutex_unlock(&pwm_engine.lock);
+        return;
+    }
+
+    pwm_motion_detach(ch, 1);
+    for (pwm_channel_t **p = &pwm_engine.channels; *p; p = &(*p)->next) {
+        if (*p == ch) {
+            *p = ch->next;
+            break;
+        }
+    }
+    close(ch->fd);
+    ch->fd = -1;
+    ch->is_closed = 1;
+
+    if (!pwm_engine.channels && pwm_engine.running) {
+        pwm_engine.running = 0;
+        thread = pwm_engine.thread;
+        pthread_cond_signal(&pwm_engine.cond);
+    }
+    pthread_mutex_unlock(&pwm_engine.lock);
+
+    if (thread) {
+        pthread_join(thread, NULL);
+        pthread_cond_destroy(&pwm_engine.cond);
+    }
+}
+
+static void finalize_pwm(napi_env env, void* finalize_data, void* finalize_hint) {
+    pwm_channel_t *ch = (pwm_channel_t*)finalize_data;
+    if (ch) {
+        pwm_channel_close(ch);
+        free(ch);
+    }
+}
+
+// Lire un handle de canal PWM ouvert
+static pwm_channel_t* get_pwm_channel(napi_env env, napi_value value) {
+    pwm_channel_t *ch = NULL;
+    napi_status status = napi_get_value_external(env, value, (void**)&ch);
+    if (status != napi_ok || ch == NULL) {
+        napi_throw_error(env, NULL, "Invalid PWM handle");
+        return NULL;
+    }
+    if (ch->is_closed) {
+        napi_throw_error(env, NULL, "PWM handle has been closed");
+        return NULL;
+    }
+    return ch;
+}
+
+// Fonction: pwmOpen(dutyCyclePath, dutyNs)
+static napi_value PwmOpen(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    char path[256];
+    int64_t duty_ns;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected path and duty arguments");
+        return NULL;
+    }
+
+    if (napi_get_value_string_utf8(env, args[0], path, sizeof(path), NULL) != napi_ok ||
+        napi_get_value_int64(env, args[1], &duty_ns) != napi_ok) {
+        napi_throw_error(env, NULL, "Invalid path or duty");
+        return NULL;
+    }
+
+    pwm_channel_t *ch = (pwm_channel_t*)malloc(sizeof(pwm_channel_t));
+    if (!ch) {
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+    memset(ch, 0, sizeof(pwm_channel_t));
+    ch->duty_ns = duty_ns;
+
+    ch->fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (ch->fd < 0) {
+        free(ch);
+        napi_throw_error(env, NULL, "Failed to open PWM duty cycle");
+        return NULL;
+    }
+
+    // Enregistrer le canal et démarrer le moteur si nécessaire
+    pthread_mutex_lock(&pwm_engine.lock);
+    ch->next = pwm_engine.channels;
+    pwm_engine.channels = ch;
+    if (!pwm_engine.running) {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&pwm_engine.cond, &attr);
+        pthread_condattr_destroy(&attr);
+
+        pwm_engine.running = 1;
+        if (pthread_create(&pwm_engine.thread, NULL, pwm_engine_thread_func, NULL) != 0) {
+            pwm_engine.running = 0;
+            pwm_engine.channels = ch->next;
+            pthread_mutex_unlock(&pwm_engine.lock);
+            pthread_cond_destroy(&pwm_engine.cond);
+            close(ch->fd);
+            free(ch);
+            napi_throw_error(env, NULL, "Failed to create PWM motion thread");
+            return NULL;
+        }
+    }
+    pthread_mutex_unlock(&pwm_engine.lock);
+
+    napi_value external;
+    status = napi_create_external(env, ch, finalize_pwm, NULL, &external);
+    if (status != napi_ok) {
+        finalize_pwm(env, ch, NULL);
+        napi_throw_error(env, NULL, "Failed to create external");
+        return NULL;
+    }
+
+    return external;
+}
+
+// Fonction: pwmWrite(handle, dutyNs) - annule le mouvement en cours
+static napi_value PwmWrite(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    int64_t duty_ns;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc < 2) {
+        napi_throw_error(env, NULL, "Expected handle and duty arguments");
+        return NULL;
+    }
+
+    pwm_channel_t *ch = get_pwm_channel(env, args[0]);
+    if (!ch) return NULL;
+
+    if (napi_get_value_int64(env, args[1], &duty_ns) != napi_ok) {
+        napi_throw_error(env, NULL, "Invalid duty");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pwm_engine.lock);
+    pwm_motion_detach(ch, 1);
+    int ret = pwm_write_duty(ch, duty_ns);
+    pthread_mutex_unlock(&pwm_engine.lock);
+
+    if (ret < 0) {
+        napi_throw_error(env, NULL, "Failed to set PWM duty cycle");
+        return NULL;
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Callback de fin de mouvement appelé depuis le thread JavaScript: résout la promesse
+static void call_js_motion(napi_env env, napi_value js_callback, void* context, void* data) {
+    pwm_motion_t *motion = (pwm_motion_t*)data;
+    if (motion == NULL) {
+        return;
+    }
+
+    if (env != NULL) {
+        napi_value result;
+        napi_get_boolean(env, !motion->cancelled, &result);
+        napi_resolve_deferred(env, motion->deferred, result);
+    }
+
+    free(motion);
+}
+
+// Fonction: pwmMove(handles, dutiesNs, durationMs, profile, rateHz)
+// Retourne une promesse résolue à true en fin de mouvement, false si annulé
+static napi_value PwmMove(napi_env env, napi_callback_info info) {
+    size_t argc = 5;
+    napi_value args[5];
+    uint32_t count = 0, duty_count = 0;
+    int duration_ms, rate_hz;
+    char profile_str[32] = "linear";
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 5) {
+        napi_throw_error(env, NULL, "Expected handles, duties, duration, profile and rate arguments");
+        return NULL;
+    }
+
+    if (napi_get_array_length(env, args[0], &count) != napi_ok ||
+        napi_get_array_length(env, args[1], &duty_count) != napi_ok ||
+        count == 0 || count != duty_count) {
+        napi_throw_error(env, NULL, "Expected arrays of handles and duties of same length");
+        return NULL;
+    }
+
+    if (napi_get_value_int32(env, args[2], &duration_ms) != napi_ok || duration_ms < 0 ||
+        napi_get_value_int32(env, args[4], &rate_hz) != napi_ok || rate_hz < 1 || rate_hz > PWM_RATE_MAX) {
+        napi_throw_error(env, NULL, "Invalid duration or rate");
+        return NULL;
+    }
+
+    napi_get_value_string_utf8(env, args[3], profile_str, sizeof(profile_str), NULL);
+    int profile;
+    if (strcmp(profile_str, "linear") == 0) {
+        profile = PWM_PROFILE_LINEAR;
+    } else if (strcmp(profile_str, "trapezoidal") == 0) {
+        profile = PWM_PROFILE_TRAPEZOIDAL;
+    } else if (strcmp(profile_str, "s-curve") == 0) {
+        profile = PWM_PROFILE_SCURVE;
+    } else {
+        napi_throw_error(env, NULL, "Unknown motion profile");
+        return NULL;
+    }
+
+    pwm_channel_t **channels = (pwm_channel_t**)calloc(count, sizeof(pwm_channel_t*));
+    int64_t *targets = (int64_t*)calloc(count, sizeof(int64_t));
+    if (!channels || !targets) {
+        free(channels);
+        free(targets);
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        napi_value item;
+        napi_get_element(env, args[0], i, &item);
+        channels[i] = get_pwm_channel(env, item);
+        napi_get_element(env, args[1], i, &item);
+        if (!channels[i] || napi_get_value_int64(env, item, &targets[i]) != napi_ok) {
+            if (channels[i]) napi_throw_error(env, NULL, "Invalid duty");
+            free(channels);
+            free(targets);
+            return NULL;
+        }
+    }
+
+    pwm_motion_t *motion = (pwm_motion_t*)malloc(sizeof(pwm_motion_t));
+    if (!motion) {
+        free(channels);
+        free(targets);
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+    memset(motion, 0, sizeof(pwm_motion_t));
+    motion->profile = profile;
+    motion->duration_ns = (uint64_t)duration_ms * 1000000ULL;
+    motion->period_ns = 1000000000ULL / (uint64_t)rate_hz;
+
+    napi_value promise, async_resource_name;
+    napi_create_promise(env, &motion->deferred, &promise);
+    napi_create_string_utf8(env, "PWMMotion", NAPI_AUTO_LENGTH, &async_resource_name);
+
+    status = napi_create_threadsafe_function(env, NULL, NULL, async_resource_name,
+        0, 1, NULL, NULL, NULL, call_js_motion, &motion->tsfn);
+    if (status != napi_ok) {
+        free(channels);
+        free(targets);
+        free(motion);
+        napi_throw_error(env, NULL, "Failed to create threadsafe function");
+        return NULL;
+    }
+
+    // Reprendre chaque canal à sa position courante (les mouvements en cours sont annulés)
+    pthread_mutex_lock(&pwm_engine.lock);
+    motion->start_ns = monotonic_ns();
+    motion->next_tick_ns = motion->start_ns;
+    for (uint32_t i = 0; i < count; i++) {
+        if (channels[i]->motion != motion) {
+            pwm_motion_detach(channels[i], 1);
+            channels[i]->from_ns = channels[i]->duty_ns;
+            channels[i]->to_ns = targets[i];
+            channels[i]->motion = motion;
+            motion->pending++;
+        }
+    }
+    pthread_cond_signal(&pwm_engine.cond);
+    pthread_mutex_unlock(&pwm_engine.lock);
+
+    free(channels);
+    free(targets);
+    return promise;
+}
+
+// Fonction: pwmCancel(handle) - arrêter le mouvement à la position courante
+static napi_value PwmCancel(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    pwm_channel_t *ch = NULL;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc >= 1 && napi_get_value_external(env, args[0], (void**)&ch) == napi_ok && ch) {
+        pthread_mutex_lock(&pwm_engine.lock);
+        pwm_motion_detach(ch, 1);
+        pthread_mutex_unlock(&pwm_engine.lock);
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fonction: pwmClose(handle)
+static napi_value PwmClose(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    pwm_channel_t *ch = NULL;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc >= 1 && napi_get_value_external(env, args[0], (void**)&ch) == napi_ok && ch) {
+        pwm_channel_close(ch);
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Lignes d'une requête multi-lignes, dans l'ordre des offsets demandés
+typedef struct {
+    struct gpiod_chip *chip;
+#ifdef LIBGPIOD_V2
+    struct gpiod_line_request *request;
+#else
+    struct gpiod_line_bulk bulk;
+#endif
+    unsigned int offsets[BULK_LINES_MAX];
+    int count;
+} gpio_bulk_t;
+
+// Demander plusieurs lignes en une seule requête: sorties avec leurs valeurs initiales
+// et leur mode de sortie (drive "push-pull" ou "open-drain"), ou entrées avec bias et
+// détection des deux fronts si edges
+static int bulk_request(gpio_bulk_t *bulk, const char *chip_name, const unsigned int *offsets, int count,
+                        int output, const int *values, const char *drive, const char *bias, int edges) {
+    memset(bulk, 0, sizeof(gpio_bulk_t));
+    if (count < 1 || count > BULK_LINES_MAX) return -1;
+    memcpy(bulk->offsets, offsets, count * sizeof(unsigned int));
+    bulk->count = count;
+
+    bulk->chip = gpiod_chip_open(chip_name);
+    if (!bulk->chip) return -1;
+
+#ifdef LIBGPIOD_V2
+    struct gpiod_line_settings *settings = gpiod_line_settings_new();
+    struct gpiod_line_config *line_cfg = gpiod_line_config_new();
+    struct gpiod_request_config *req_cfg = gpiod_request_config_new();
+    int ret = (settings && line_cfg && req_cfg) ? 0 : -1;
+
+    if (ret == 0) {
+        if (output) {
+            gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_OUTPUT);
+            if (strcmp(drive, "open-drain") == 0) {
+                gpiod_line_settings_set_drive(settings, GPIOD_LINE_DRIVE_OPEN_DRAIN);
+            }
+        } else {
+            gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+            if (strcmp(bias, "pull-up") == 0) {
+                gpiod_line_settings_set_bias(settings, GPIOD_LINE_BIAS_PULL_UP);
+            } else if (strcmp(bias, "pull-down") == 0) {
+                gpiod_line_settings_set_bias(settings, GPIOD_LINE_BIAS_PULL_DOWN);
+            } else {
+                gpiod_line_settings_set_bias(settings, GPIOD_LINE_BIAS_DISABLED);
+            }
+            if (edges) {
+                gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+            }
+        }
+
+        // Une entrée de configuration par ligne pour sa valeur initiale (compatible libgpiod 2.0)
+        for (int i = 0; i < count && ret == 0; i++) {
+            if (output) {
+                gpiod_line_settings_set_output_value(settings,
+                    values[i] ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE);
+            }
+            ret = gpiod_line_config_add_line_settings(line_cfg, &bulk->offsets[i], 1, settings);
+        }
+    }
+
+    if (ret == 0) {
+        gpiod_request_config_set_consumer(req_cfg, "nodejs-gpio");
+        bulk->request = gpiod_chip_request_lines(bulk->chip, req_cfg, line_cfg);
+        if (!bulk->request) ret = -1;
+    }
+
+    if (settings) gpiod_line_settings_free(settings);
+    if (line_cfg) gpiod_line_config_free(line_cfg);
+    if (req_cfg) gpiod_request_config_free(req_cfg);
+#else
+    int ret = gpiod_chip_get_lines(bulk->chip, bulk->offsets, count, &bulk->bulk);
+    if (ret == 0) {
+        if (output) {
+            int flags = strcmp(drive, "open-drain") == 0 ? GPIOD_LINE_REQUEST_FLAG_OPEN_DRAIN : 0;
+            ret = gpiod_line_request_bulk_output_flags(&bulk->bulk, "nodejs-gpio", flags, values);
+        } else {
+            int flags = GPIOD_LINE_REQUEST_FLAG_BIAS_DISABLE;
+            if (strcmp(bias, "pull-up") == 0) {
+                flags = GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP;
+            } else if (strcmp(bias, "pull-down") == 0) {
+                flags = GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_DOWN;
+            }
+            ret = edges ? gpiod_line_request_bulk_both_edges_events_flags(&bulk->bulk, "nodejs-gpio", flags)
+                        : gpiod_line_request_bulk_input_flags(&bulk->bulk, "nodejs-gpio", flags);
+        }
+    }
+#endif
+
+    if (ret < 0) {
+        gpiod_chip_close(bulk->chip);
+        bulk->chip = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+// Écrire une ligne de la requête (index dans l'ordre des offsets)
+static int bulk_set_value(gpio_bulk_t *bulk, int index, int value) {
+#ifdef LIBGPIOD_V2
+    return gpiod_line_request_set_value(bulk->request, bulk->offsets[index],
+        value ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE);
+#else
+    return gpiod_line_set_value(gpiod_line_bulk_get_line(&bulk->bulk, index), value ? 1 : 0);
+#endif
+}
+
+// Écrire toutes les lignes de la requête en un appel
+static int bulk_set_values(gpio_bulk_t *bulk, const int *values) {
+#ifdef LIBGPIOD_V2
+    enum gpiod_line_value v[BULK_LINES_MAX];
+    for (int i = 0; i < bulk->count; i++) {
+        v[i] = values[i] ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
+    }
+    return gpiod_line_request_set_values(bulk->request, v);
+#else
+    return gpiod_line_set_value_bulk(&bulk->bulk, values);
+#endif
+}
+
+// Lire toutes les lignes de la requête en un appel
+static int bulk_get_values(gpio_bulk_t *bulk, int *values) {
+#ifdef LIBGPIOD_V2
+    enum gpiod_line_value v[BULK_LINES_MAX];
+    if (gpiod_line_request_get_values(bulk->request, v) < 0) return -1;
+    for (int i = 0; i < bulk->count; i++) {
+        values[i] = (v[i] == GPIOD_LINE_VALUE_ACTIVE) ? 1 : 0;
+    }
+    return 0;
+#else
+    return gpiod_line_get_value_bulk(&bulk->bulk, values);
+#endif
+}
+
+// Libérer les lignes et le chip de la requête
+static void bulk_release(gpio_bulk_t *bulk) {
+#ifdef LIBGPIOD_V2
+    if (bulk->request) {
+        gpiod_line_request_release(bulk->request);
+        bulk->request = NULL;
+    }
+#else
+    if (bulk->chip) {
+        gpiod_line_release_bulk(&bulk->bulk);
+    }
+#endif
+    if (bulk->chip) {
+        gpiod_chip_close(bulk->chip);
+        bulk->chip = NULL;
+    }
+}
+
+// Chercher une ligne parmi les count premières
+static int line_index(const unsigned int *offsets, int count, unsigned int line) {
+    for (int i = 0; i < count; i++) {
+        if (offsets[i] == line) return i;
+    }
+    return -1;
+}
+
+// Lire un tableau de numéros de lignes, -1 si invalide ou si une ligne est en double
+static int get_line_array(napi_env env, napi_value array, unsigned int *offsets, int max) {
+    uint32_t count = 0;
+    if (napi_get_array_length(env, array, &count) != napi_ok || count < 1 || count > (uint32_t)max) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        napi_value item;
+        int32_t line;
+        if (napi_get_element(env, array, i, &item) != napi_ok ||
+            napi_get_value_int32(env, item, &line) != napi_ok || line < 0 ||
+            line_index(offsets, (int)i, (unsigned int)line) >= 0) {
+            return -1;
+        }
+        offsets[i] = (unsigned int)line;
+    }
+    return (int)count;
+}
+
+// Attente active jusqu'à l'instant donné (quelques µs au plus)
+static void spin_until(uint64_t target_ns) {
+    while (monotonic_ns() < target_ns) {
+    }
+}
+
+// Rampe de vitesse d'un mouvement de n pas: accélération de v0 à vp, palier, décélération à 0
+typedef struct {
+    double n;
+    double v0, vp, a;   // pas/s, pas/s²
+    double sa, sd;      // pas en accélération et en décélération
+    double ta, td, t;   // durées (s) d'accélération, de décélération et totale
+} stepper_ramp_t;
+
+static void stepper_ramp_init(stepper_ramp_t *r, double n, double v0, double vmax, double a) {
+    r->n = n;
+    r->a = a;
+    if (a <= 0) {
+        // Sans rampe: vitesse constante
+        r->v0 = r->vp = vmax;
+        r->sa = r->sd = r->ta = r->td = 0;
+        r->t = n / vmax;
+        return;
+    }
+
+    r->v0 = v0 < vmax ? v0 : vmax;
+    r->vp = vmax;
+    if ((vmax * vmax - r->v0 * r->v0) / (2 * a) + vmax * vmax / (2 * a) > n) {
+        // Profil triangulaire: la vitesse max n'est pas atteinte
+        r->vp = sqrt(a * n + r->v0 * r->v0 / 2);
+        if (r->vp < r->v0) r->vp = r->v0;
+    }
+    r->sa = (r->vp * r->vp - r->v0 * r->v0) / (2 * a);
+    r->sd = r->vp * r->vp / (2 * a);
+    if (r->sa + r->sd > n) r->sd = n - r->sa;
+    r->ta = (r->vp - r->v0) / a;
+    r->td = r->vp / a;
+    r->t = r->ta + (n - r->sa - r->sd) / r->vp + r->td;
+}
+
+// Instant (s) où la position s (pas) est atteinte
+static double stepper_ramp_time(const stepper_ramp_t *r, double s) {
+    if (r->a <= 0) return s / r->vp;
+    if (s <= r->sa) return (sqrt(r->v0 * r->v0 + 2 * r->a * s) - r->v0) / r->a;
+    if (s <= r->n - r->sd) return r->ta + (s - r->sa) / r->vp;
+    double rest = r->n - s;
+    return r->t - sqrt(2 * rest / r->a);
+}
+
+// Vitesse (pas/s) à l'instant t (s)
+static double stepper_ramp_speed(const stepper_ramp_t *r, double t) {
+    if (r->a <= 0) return r->vp;
+    if (t < r->ta) return r->v0 + r->a * t;
+    if (t < r->t - r->td) return r->vp;
+    return t < r->t ? r->a * (r->t - t) : 0;
+}
+
+// Mouvement demandé par stepperMove()
+typedef struct {
+    napi_threadsafe_function tsfn;
+    napi_deferred deferred;
+    int64_t steps;      // signé: le sens donne DIR
+    double max_speed;
+    double accel;
+    int completed;
+} stepper_move_t;
+
+// Moteur pas à pas: STEP, DIR et ENABLE optionnel dans une seule requête
+typedef struct {
+    gpio_bulk_t lines;
+    int enable_level;   // niveau actif de ENABLE, -1 sans ligne ENABLE
+    int realtime;       // thread en SCHED_FIFO si autorisé
+    int is_closed;
+    int64_t position;   // pas, accès atomiques
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    int running;
+    int stop;           // STEPPER_STOP_SOFT ou STEPPER_STOP_HARD pendant un mouvement
+    stepper_move_t *move;
+} stepper_t;
+
+// Exécuter un mouvement, appelé avec le verrou du moteur
+static void stepper_run(stepper_t *st, stepper_move_t *move) {
+    int dir = move->steps < 0 ? -1 : 1;
+    int64_t total = move->steps < 0 ? -move->steps : move->steps;
+    int64_t done = 0, base = 0;
+    int replanned = 0;
+    stepper_ramp_t ramp;
+
+    // Sens puis délai de prise en compte par le driver avant le premier pas
+    pthread_mutex_unlock(&st->lock);
+    bulk_set_value(&st->lines, STEPPER_DIR, dir > 0 ? 1 : 0);
+    spin_until(monotonic_ns() + STEPPER_DIR_SETUP_NS);
+    pthread_mutex_lock(&st->lock);
+
+    stepper_ramp_init(&ramp, (double)total, 0, move->max_speed, move->accel);
+    uint64_t start = monotonic_ns();
+    uint64_t last = start; // instant du pas précédent
+
+    while (done < total && st->running && st->stop != STEPPER_STOP_HARD) {
+        if (st->stop == STEPPER_STOP_SOFT && !replanned) {
+            // Décélération depuis la vitesse courante jusqu'à l'arrêt
+            uint64_t now = monotonic_ns();
+            double v = stepper_ramp_speed(&ramp, (double)(now - start) / 1e9);
+            int64_t rest = ramp.a > 0 ? (int64_t)ceil(v * v / (2 * ramp.a)) : 0;
+            if (rest > total - done) rest = total - done;
+            replanned = 1;
+            if (rest <= 0) break;
+
+            total = done + rest;
+            base = done;
+            stepper_ramp_init(&ramp, (double)rest, v, v, move->accel);
+            start = now;
+        }
+
+        // Le pas k est émis quand la rampe atteint la position k + 0.5
+        uint64_t target = start + (uint64_t)(stepper_ramp_time(&ramp, (double)(done - base) + 0.5) * 1e9);
+        uint64_t now = monotonic_ns();
+
+        // L'attente active ne prend qu'une part de la période: à haute vitesse le
+        // thread dort entre les pas au lieu d'occuper le cœur en priorité temps réel
+        uint64_t spin = target > last ? (target - last) / STEPPER_SPIN_SHARE : 0;
+        if (spin > STEPPER_SPIN_NS) spin = STEPPER_SPIN_NS;
+
+        if (now > target) {
+            // Retard du thread: décaler la rampe plutôt qu'émettre des pas en rafale
+            start += now - target;
+            target = now;
+        } else if (now + spin < target) {
+            // Attente interruptible par stepperStop()/close, fin en attente active
+            uint64_t wake = target - spin;
+            struct timespec ts;
+            ts.tv_sec = wake / 1000000000ULL;
+            ts.tv_nsec = wake % 1000000000ULL;
+            pthread_cond_timedwait(&st->cond, &st->lock, &ts);
+            continue;
+        }
+
+        pthread_mutex_unlock(&st->lock);
+        spin_until(target);
+        bulk_set_value(&st->lines, STEPPER_STEP, 1);
+        spin_until(monotonic_ns() + STEPPER_PULSE_NS);
+        bulk_set_value(&st->lines, STEPPER_STEP, 0);
+        __atomic_add_fetch(&st->position, dir, __ATOMIC_RELAXED);
+        last = target;
+        done++;
+        pthread_mutex_lock(&st->lock);
+    }
+
+    move->completed = !st->stop && done == total;
+}
+
+// Transmettre la fin d'un mouvement au thread JavaScript qui le libère, ici si
+// l'appel est refusé (environnement en cours de fermeture)
+static void stepper_finish(stepper_move_t *move) {
+    napi_threadsafe_function tsfn = move->tsfn;
+    if (napi_call_threadsafe_function(tsfn, move, napi_tsfn_nonblocking) != napi_ok) {
+        free(move);
+    }
+    napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+}
+
+// Thread du moteur: un mouvement à la fois
+static void* stepper_thread_func(void* arg) {
+    stepper_t *st = (stepper_t*)arg;
+
+    // Priorité temps réel si demandée et autorisée (root ou CAP_SYS_NICE)
+    if (st->realtime) {
+        struct sched_param param = { .sched_priority = STEPPER_PRIORITY };
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    }
+
+    pthread_mutex_lock(&st->lock);
+    while (st->running) {
+        stepper_move_t *move = st->move;
+        if (!move) {
+            pthread_cond_wait(&st->cond, &st->lock);
+            continue;
+        }
+
+        stepper_run(st, move);
+
+        st->move = NULL;
+        st->stop = 0;
+        stepper_finish(move);
+    }
+
+    // Fermeture avant la prise en compte d'un mouvement demandé: il est annulé
+    if (st->move) {
+        st->move->completed = 0;
+        stepper_finish(st->move);
+        st->move = NULL;
+    }
+    pthread_mutex_unlock(&st->lock);
+    return NULL;
+}
+
+// Arrêter le thread, désactiver le driver et libérer les lignes
+static void stepper_close(stepper_t *st) {
+    if (st->is_closed) return;
+
+    pthread_mutex_lock(&st->lock);
+    st->running = 0;
+    pthread_cond_signal(&st->cond);
+    pthread_mutex_unlock(&st->lock);
+    pthread_join(st->thread, NULL);
+
+    if (st->enable_level >= 0) {
+        bulk_set_value(&st->lines, STEPPER_ENABLE, !st->enable_level);
+    }
+    bulk_release(&st->lines);
+    st->is_closed = 1;
+}
+
+static void finalize_stepper(napi_env env, void* finalize_data, void* finalize_hint) {
+    stepper_t *st = (stepper_t*)finalize_data;
+    if (st) {
+        stepper_close(st);
+        pthread_cond_destroy(&st->cond);
+        pthread_mutex_destroy(&st->lock);
+        free(st);
+    }
+}
+
+// Lire un handle de moteur pas à pas ouvert
+static stepper_t* get_stepper(napi_env env, napi_value value) {
+    stepper_t *st = NULL;
+    napi_status status = napi_get_value_external(env, value, (void**)&st);
+    if (status != napi_ok || st == NULL) {
+        napi_throw_error(env, NULL, "Invalid stepper handle");
+        return NULL;
+    }
+    if (st->is_closed) {
+        napi_throw_error(env, NULL, "Stepper handle has been closed");
+        return NULL;
+    }
+    return st;
+}
+
+// Fonction: stepperOpen(chipName, [step, dir, enable], enableLevel, realtime)
+static napi_value StepperOpen(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    char chip_name[256];
+    unsigned int offsets[BULK_LINES_MAX];
+    int enable_level = 0;
+    bool realtime = true;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected chipName and lines arguments");
+        return NULL;
+    }
+
+    if (napi_get_value_string_utf8(env, args[0], chip_name, sizeof(chip_name), NULL) != napi_ok) {
+        napi_throw_error(env, NULL, "Invalid chip name");
+        return NULL;
+    }
+
+    int count = get_line_array(env, args[1], offsets, 3);
+    if (count < 2) {
+        napi_throw_error(env, NULL, "Expected distinct lines [step, dir] or [step, dir, enable]");
+        return NULL;
+    }
+
+    if (argc >= 3) {
+        napi_get_value_int32(env, args[2], &enable_level);
+    }
+    if (argc >= 4) {
+        napi_get_value_bool(env, args[3], &realtime);
+    }
+
+    stepper_t *st = (stepper_t*)malloc(sizeof(stepper_t));
+    if (!st) {
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+    memset(st, 0, sizeof(stepper_t));
+    st->enable_level = count == 3 ? (enable_level ? 1 : 0) : -1;
+    st->realtime = realtime;
+
+    // STEP et DIR à 0, driver activé dès l'ouverture (couple de maintien)
+    int values[3] = { 0, 0, st->enable_level };
+    if (bulk_request(&st->lines, chip_name, offsets, count, 1, values, "push-pull", "disable", 0) < 0) {
+        free(st);
+        napi_throw_error(env, NULL, "Failed to request stepper lines as outputs");
+        return NULL;
+    }
+
+    pthread_mutex_init(&st->lock, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&st->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    st->running = 1;
+    if (pthread_create(&st->thread, NULL, stepper_thread_func, st) != 0) {
+        bulk_release(&st->lines);
+        pthread_cond_destroy(&st->cond);
+        pthread_mutex_destroy(&st->lock);
+        free(st);
+        napi_throw_error(env, NULL, "Failed to create stepper thread");
+        return NULL;
+    }
+
+    napi_value external;
+    status = napi_create_external(env, st, finalize_stepper, NULL, &external);
+    if (status != napi_ok) {
+        finalize_stepper(env, st, NULL);
+        napi_throw_error(env, NULL, "Failed to create external");
+        return NULL;
+    }
+
+    return external;
+}
+
+// Fin de mouvement appelée depuis le thread JavaScript: résout la promesse
+static void call_js_stepper(napi_env env, napi_value js_callback, void* context, void* data) {
+    stepper_move_t *move = (stepper_move_t*)data;
+    if (move == NULL) {
+        return;
+    }
+
+    if (env != NULL) {
+        napi_value result;
+        napi_get_boolean(env, move->completed, &result);
+        napi_resolve_deferred(env, move->deferred, result);
+    }
+
+    free(move);
+}
+
+// Fonction: stepperMove(handle, steps, maxSpeed, accel)
+// Retourne une promesse résolue à true en fin de mouvement, false si arrêté
+static napi_value StepperMove(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    int64_t steps;
+    double max_speed, accel;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 4) {
+        napi_throw_error(env, NULL, "Expected handle, steps, maxSpeed and accel arguments");
+        return NULL;
+    }
+
+    stepper_t *st = get_stepper(env, args[0]);
+    if (!st) return NULL;
+
+    if (napi_get_value_int64(env, args[1], &steps) != napi_ok ||
+        napi_get_value_double(env, args[2], &max_speed) != napi_ok ||
+        napi_get_value_double(env, args[3], &accel) != napi_ok ||
+        !(max_speed > 0) || max_speed > STEPPER_SPEED_MAX || !(accel >= 0)) {
+        napi_throw_error(env, NULL, "Invalid steps, speed or acceleration");
+        return NULL;
+    }
+
+    stepper_move_t *move = (stepper_move_t*)malloc(sizeof(stepper_move_t));
+    if (!move) {
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+    memset(move, 0, sizeof(stepper_move_t));
+    move->steps = steps;
+    move->max_speed = max_speed;
+    move->accel = accel;
+
+    napi_value promise, async_resource_name;
+    napi_create_promise(env, &move->deferred, &promise);
+    napi_create_string_utf8(env, "StepperMove", NAPI_AUTO_LENGTH, &async_resource_name);
+
+    pthread_mutex_lock(&st->lock);
+    if (st->move) {
+        pthread_mutex_unlock(&st->lock);
+        free(move);
+        napi_throw_error(env, NULL, "Stepper is already moving");
+        return NULL;
+    }
+
+    status = napi_create_threadsafe_function(env, NULL, NULL, async_resource_name,
+        0, 1, NULL, NULL, NULL, call_js_stepper, &move->tsfn);
+    if (status != napi_ok) {
+        pthread_mutex_unlock(&st->lock);
+        free(move);
+        napi_throw_error(env, NULL, "Failed to create threadsafe function");
+        return NULL;
+    }
+
+    st->stop = 0;
+    st->move = move;
+    pthread_cond_signal(&st->cond);
+    pthread_mutex_unlock(&st->lock);
+
+    return promise;
+}
+
+// Fonction: stepperStop(handle, hard) - décélérer jusqu'à l'arrêt, immédiat si hard
+static napi_value StepperStop(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    bool hard = false;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    stepper_t *st = argc >= 1 ? get_stepper(env, args[0]) : NULL;
+    if (!st) return NULL;
+    if (argc >= 2) {
+        napi_get_value_bool(env, args[1], &hard);
+    }
+
+    pthread_mutex_lock(&st->lock);
+    if (st->move && st->stop != STEPPER_STOP_HARD) {
+        st->stop = hard ? STEPPER_STOP_HARD : STEPPER_STOP_SOFT;
+        pthread_cond_signal(&st->cond);
+    }
+    pthread_mutex_unlock(&st->lock);
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fonction: stepperPosition(handle, [position]) - lire ou redéfinir la position (pas)
+static napi_value StepperPosition(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    stepper_t *st = argc >= 1 ? get_stepper(env, args[0]) : NULL;
+    if (!st) return NULL;
+
+    if (argc >= 2) {
+        int64_t position;
+        if (napi_get_value_int64(env, args[1], &position) != napi_ok) {
+            napi_throw_error(env, NULL, "Invalid position");
+            return NULL;
+        }
+        pthread_mutex_lock(&st->lock);
+        int moving = st->move != NULL;
+        if (!moving) {
+            __atomic_store_n(&st->position, position, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&st->lock);
+        if (moving) {
+            napi_throw_error(env, NULL, "Cannot set position while stepper is moving");
+            return NULL;
+        }
+    }
+
+    napi_value result;
+    napi_create_int64(env, __atomic_load_n(&st->position, __ATOMIC_RELAXED), &result);
+    return result;
+}
+
+// Fonction: stepperClose(handle) - le mouvement en cours est résolu à false
+static napi_value StepperClose(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    stepper_t *st = NULL;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc >= 1 && napi_get_value_external(env, args[0], (void**)&st) == napi_ok && st) {
+        stepper_close(st);
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Échantillonneur: lecture de toutes les lignes en un appel à chaque tick
+typedef struct {
+    int index;
+    int value;
+    uint64_t timestamp_ns;
+} sampler_event_t;
+
+typedef struct {
+    gpio_bulk_t lines;
+    int is_closed;
+    pthread_t thread;
+    volatile int running;
+    uint64_t period_ns;
+    int realtime;       // thread en SCHED_FIFO si autorisé
+    napi_threadsafe_function tsfn;
+
+    // Filtre intégrateur: compteur 0..window par ligne, état stable basculé aux bornes
+    int window;
+    uint32_t state;     // un bit par ligne
+    uint8_t counter[BULK_LINES_MAX];
+
+    // Échantillons bruts: file circulaire un producteur (thread) / un consommateur (JS)
+    uint32_t capacity;  // 0 en mode filtré
+    uint32_t *values;
+    uint64_t *times;
+    uint64_t head;      // écrit par le thread
+    uint64_t tail;      // écrit par samplerRead()
+    uint64_t dropped;   // échantillons perdus, file pleine
+    uint64_t missed;    // ticks sautés, thread en retard
+} sampler_t;
+
+// Lire toutes les lignes de la requête en un masque de bits
+static int sampler_get_bits(sampler_t *s, uint32_t *bits) {
+    int values[BULK_LINES_MAX];
+    if (bulk_get_values(&s->lines, values) < 0) return -1;
+
+    *bits = 0;
+    for (int i = 0; i < s->lines.count; i++) {
+        *bits |= (uint32_t)(values[i] ? 1 : 0) << i;
+    }
+    return 0;
+}
+
+// Intégrer un échantillon et notifier JavaScript des changements d'état stable
+static void sampler_filter(sampler_t *s, uint32_t bits, uint64_t timestamp_ns) {
+    uint32_t state = s->state;
+
+    for (int i = 0; i < s->lines.count; i++) {
+        uint32_t mask = (uint32_t)1 << i;
+        if (bits & mask) {
+            if (s->counter[i] < s->window) s->counter[i]++;
+        } else if (s->counter[i] > 0) {
+            s->counter[i]--;
+        }
+
+        int change = (state & mask) ? s->counter[i] == 0 : s->counter[i] == s->window;
+        if (!change) continue;
+
+        state ^= mask;
+        if (s->tsfn) {
+            sampler_event_t *data = (sampler_event_t*)malloc(sizeof(sampler_event_t));
+            if (data) {
+                data->index = i;
+                data->value = (state & mask) ? 1 : 0;
+                data->timestamp_ns = timestamp_ns;
+                napi_call_threadsafe_function(s->tsfn, data, napi_tsfn_nonblocking);
+            }
+        }
+    }
+
+    __atomic_store_n(&s->state, state, __ATOMIC_RELAXED);
+}
+
+// Ajouter un échantillon brut à la file, perdu si elle est pleine
+static void sampler_push(sampler_t *s, uint32_t bits, uint64_t timestamp_ns) {
+    uint64_t head = s->head;
+    if (head - __atomic_load_n(&s->tail, __ATOMIC_ACQUIRE) >= s->capacity) {
+        __atomic_fetch_add(&s->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    s->values[head % s->capacity] = bits;
+    s->times[head % s->capacity] = timestamp_ns;
+    __atomic_store_n(&s->head, head + 1, __ATOMIC_RELEASE);
+}
+
+// Thread d'échantillonnage: ticks à échéance absolue, ticks manqués sautés et comptés
+static void* sampler_thread_func(void* arg) {
+    sampler_t *s = (sampler_t*)arg;
+
+    // Priorité temps réel si demandée et autorisée (root ou CAP_SYS_NICE)
+    if (s->realtime) {
+        struct sched_param param = { .sched_priority = SAMPLER_PRIORITY };
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    }
+
+    uint64_t next = monotonic_ns();
+    while (s->running) {
+        uint32_t bits;
+        uint64_t now = monotonic_ns();
+        if (sampler_get_bits(s, &bits) == 0) {
+            if (s->capacity) {
+                sampler_push(s, bits, now);
+            } else {
+                sampler_filter(s, bits, now);
+            }
+        }
+
+        next += s->period_ns;
+        now = monotonic_ns();
+        if (next <= now) {
+            uint64_t late = (now - next) / s->period_ns + 1;
+            __atomic_fetch_add(&s->missed, late, __ATOMIC_RELAXED);
+            next += late * s->period_ns;
+        }
+
+        struct timespec ts;
+        ts.tv_sec = next / 1000000000ULL;
+        ts.tv_nsec = next % 1000000000ULL;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+
+    return NULL;
+}
+
+// Arrêter l'échantillonnage; les changements déjà en file sont encore transmis
+// et les échantillons bruts restent lisibles jusqu'au prochain démarrage
+static void sampler_stop(sampler_t *s) {
+    if (s->running) {
+        s->running = 0;
+        pthread_join(s->thread, NULL);
+    }
+
+    if (s->tsfn) {
+        napi_release_threadsafe_function(s->tsfn, napi_tsfn_release);
+        s->tsfn = NULL;
+    }
+}
+
+// Libérer la file des échantillons bruts (thread arrêté)
+static void sampler_free_buffer(sampler_t *s) {
+    free(s->values);
+    free(s->times);
+    s->values = NULL;
+    s->times = NULL;
+    s->capacity = 0;
+}
+
+static void sampler_close(sampler_t *s) {
+    if (s->is_closed) return;
+
+    sampler_stop(s);
+    sampler_free_buffer(s);
+    bulk_release(&s->lines);
+    s->is_closed = 1;
+}
+
+static void finalize_sampler(napi_env env, void* finalize_data, void* finalize_hint) {
+    sampler_t *s = (sampler_t*)finalize_data;
+    if (s) {
+        sampler_close(s);
+        free(s);
+    }
+}
+
+// Lire un handle d'échantillonneur ouvert
+static sampler_t* get_sampler(napi_env env, napi_value value) {
+    sampler_t *s = NULL;
+    napi_status status = napi_get_value_external(env, value, (void**)&s);
+    if (status != napi_ok || s == NULL) {
+        napi_throw_error(env, NULL, "Invalid sampler handle");
+        return NULL;
+    }
+    if (s->is_closed) {
+        napi_throw_error(env, NULL, "Sampler handle has been closed");
+        return NULL;
+    }
+    return s;
+}
+
+// Fonction: samplerOpen(chipName, lines, bias) - lignes en entrée sans détection de front
+static napi_value SamplerOpen(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    char chip_name[256];
+    char bias[32] = "disable";
+    unsigned int offsets[BULK_LINES_MAX];
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected chipName and lines arguments");
+        return NULL;
+    }
+
+    if (napi_get_value_string_utf8(env, args[0], chip_name, sizeof(chip_name), NULL) != napi_ok) {
+        napi_throw_error(env, NULL, "Invalid chip name");
+        return NULL;
+    }
+
+    int count = get_line_array(env, args[1], offsets, BULK_LINES_MAX);
+    if (count < 1) {
+        napi_throw_error(env, NULL, "Expected array of 1 to 32 distinct lines");
+        return NULL;
+    }
+
+    if (argc >= 3) {
+        napi_get_value_string_utf8(env, args[2], bias, sizeof(bias), NULL);
+    }
+
+    sampler_t *s = (sampler_t*)malloc(sizeof(sampler_t));
+    if (!s) {
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+    memset(s, 0, sizeof(sampler_t));
+
+    if (bulk_request(&s->lines, chip_name, offsets, count, 0, NULL, NULL, bias, 0) < 0) {
+        free(s);
+        napi_throw_error(env, NULL, "Failed to request sampler lines as inputs");
+        return NULL;
+    }
+
+    napi_value external;
+    status = napi_create_external(env, s, finalize_sampler, NULL, &external);
+    if (status != napi_ok) {
+        finalize_sampler(env, s, NULL);
+        napi_throw_error(env, NULL, "Failed to create external");
+        return NULL;
+    }
+
+    return external;
+}
+
+// Changement d'état stable appelé depuis le thread JavaScript: callback(index, value, timestamp)
+static void call_js_sampler(napi_env env, napi_value js_callback, void* context, void* data) {
+    if (data == NULL) {
+        return;
+    }
+
+    sampler_event_t *event = (sampler_event_t*)data;
+
+    if (env != NULL && js_callback != NULL) {
+        napi_value argv[3];
+        napi_status status = napi_create_int32(env, event->index, &argv[0]);
+
+        if (status == napi_ok) {
+            status = napi_create_int32(env, event->value, &argv[1]);
+        }
+
+        if (status == napi_ok) {
+            status = napi_create_bigint_uint64(env, event->timestamp_ns, &argv[2]);
+        }
+
+        if (status == napi_ok) {
+            napi_value global;
+            status = napi_get_global(env, &global);
+
+            if (status == napi_ok) {
+                napi_value result;
+                napi_call_function(env, global, js_callback, 3, argv, &result);
+            }
+        }
+    }
+
+    free(data);
+}
+
+// Fonction: samplerStart(handle, rate, window, capacity, callback, realtime)
+// capacity 0: filtre intégrateur sur window échantillons, sinon file de capacity échantillons bruts
+static napi_value SamplerStart(napi_env env, napi_callback_info info) {
+    size_t argc = 6;
+    napi_value args[6];
+    int rate, window, capacity;
+    bool realtime = true;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 4) {
+        napi_throw_error(env, NULL, "Expected handle, rate, window and capacity arguments");
+        return NULL;
+    }
+
+    sampler_t *s = get_sampler(env, args[0]);
+    if (!s) return NULL;
+
+    if (s->running) {
+        napi_throw_error(env, NULL, "Sampler already started");
+        return NULL;
+    }
+
+    if (napi_get_value_int32(env, args[1], &rate) != napi_ok ||
+        napi_get_value_int32(env, args[2], &window) != napi_ok ||
+        napi_get_value_int32(env, args[3], &capacity) != napi_ok ||
+        rate < 1 || rate > SAMPLER_RATE_MAX ||
+        window < 1 || window > SAMPLER_WINDOW_MAX ||
+        capacity < 0 || capacity > SAMPLER_CAPACITY_MAX) {
+        napi_throw_error(env, NULL, "Invalid sampler rate, window or capacity");
+        return NULL;
+    }
+    if (argc > 5) {
+        napi_get_value_bool(env, args[5], &realtime);
+    }
+
+    // État initial: premier échantillon considéré stable, sans notification
+    uint32_t bits;
+    if (sampler_get_bits(s, &bits) < 0) {
+        napi_throw_error(env, NULL, "Failed to read sampler lines");
+        return NULL;
+    }
+    s->window = window;
+    s->state = bits;
+    for (int i = 0; i < s->lines.count; i++) {
+        s->counter[i] = (bits >> i) & 1 ? (uint8_t)window : 0;
+    }
+
+    sampler_free_buffer(s);
+    s->head = s->tail = 0;
+    s->dropped = s->missed = 0;
+    if (capacity) {
+        s->values = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+        s->times = (uint64_t*)malloc(capacity * sizeof(uint64_t));
+        if (!s->values || !s->times) {
+            sampler_free_buffer(s);
+            napi_throw_error(env, NULL, "Memory allocation failed");
+            return NULL;
+        }
+        s->capacity = (uint32_t)capacity;
+    }
+
+    napi_valuetype type = napi_undefined;
+    if (argc > 4) {
+        napi_typeof(env, args[4], &type);
+    }
+    if (!capacity && type == napi_function) {
+        napi_value resource_name;
+        napi_create_string_utf8(env, "GPIOSampler", NAPI_AUTO_LENGTH, &resource_name);
+        status = napi_create_threadsafe_function(env, args[4], NULL, resource_name, 0, 1,
+            NULL, NULL, NULL, call_js_sampler, &s->tsfn);
+        if (status != napi_ok) {
+            sampler_stop(s);
+            napi_throw_error(env, NULL, "Failed to create threadsafe function");
+            return NULL;
+        }
+    }
+
+    s->period_ns = 1000000000ULL / (uint64_t)rate;
+    s->realtime = realtime;
+    s->running = 1;
+    if (pthread_create(&s->thread, NULL, sampler_thread_func, s) != 0) {
+        s->running = 0;
+        sampler_stop(s);
+        napi_throw_error(env, NULL, "Failed to create sampler thread");
+        return NULL;
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fonction: samplerStop(handle)
+static napi_value SamplerStop(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    sampler_t *s = argc >= 1 ? get_sampler(env, args[0]) : NULL;
+    if (!s) return NULL;
+
+    sampler_stop(s);
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fonction: samplerValues(handle) - masque des états stables (bit i: ligne i)
+static napi_value SamplerValues(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    sampler_t *s = argc >= 1 ? get_sampler(env, args[0]) : NULL;
+    if (!s) return NULL;
+
+    napi_value result;
+    napi_create_uint32(env, __atomic_load_n(&s->state, __ATOMIC_RELAXED), &result);
+    return result;
+}
+
+// Fonction: samplerRead(handle) - vider la file des échantillons bruts
+// Retourne {values: Uint32Array, times: BigUint64Array, dropped, missed}
+static napi_value SamplerRead(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    sampler_t *s = argc >= 1 ? get_sampler(env, args[0]) : NULL;
+    if (!s) return NULL;
+
+    uint64_t tail = s->tail;
+    uint64_t head = s->capacity ? __atomic_load_n(&s->head, __ATOMIC_ACQUIRE) : tail;
+    size_t count = (size_t)(head - tail);
+
+    napi_value values_buffer, times_buffer, values, times;
+    void *values_data = NULL, *times_data = NULL;
+    if (napi_create_arraybuffer(env, count * sizeof(uint32_t), &values_data, &values_buffer) != napi_ok ||
+        napi_create_arraybuffer(env, count * sizeof(uint64_t), &times_data, &times_buffer) != napi_ok) {
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        ((uint32_t*)values_data)[i] = s->values[(tail + i) % s->capacity];
+        ((uint64_t*)times_data)[i] = s->times[(tail + i) % s->capacity];
+    }
+    __atomic_store_n(&s->tail, head, __ATOMIC_RELEASE);
+
+    napi_create_typedarray(env, napi_uint32_array, count, values_buffer, 0, &values);
+    napi_create_typedarray(env, napi_biguint64_array, count, times_buffer, 0, &times);
+
+    napi_value result, dropped, missed;
+    napi_create_object(env, &result);
+    napi_create_int64(env, (int64_t)__atomic_load_n(&s->dropped, __ATOMIC_RELAXED), &dropped);
+    napi_create_int64(env, (int64_t)__atomic_load_n(&s->missed, __ATOMIC_RELAXED), &missed);
+    napi_set_named_property(env, result, "values", values);
+    napi_set_named_property(env, result, "times", times);
+    napi_set_named_property(env, result, "dropped", dropped);
+    napi_set_named_property(env, result, "missed", missed);
+    return result;
+}
+
+// Fonction: samplerClose(handle)
+static napi_value SamplerClose(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    sampler_t *s = NULL;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc >= 1 && napi_get_value_external(env, args[0], (void**)&s) == napi_ok && s) {
+        sampler_close(s);
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Clavier matriciel: rangées en sortie (actives à 0), colonnes en entrée avec pull-up
+typedef struct {
+    int key;
+    int down;
+    uint64_t timestamp_ns;
+} keypad_event_t;
+
+typedef struct {
+    gpio_bulk_t rows;
+    gpio_bulk_t cols;
+    int is_closed;
+    int wake_fd;        // eventfd pour réveiller le thread au repos
+    pthread_t thread;
+    volatile int running;
+    uint64_t interval_ns;
+    int debounce;       // balayages consécutifs pour valider un changement
+    napi_threadsafe_function tsfn;
+    uint8_t counter[KEYPAD_LINES_MAX * KEYPAD_LINES_MAX];
+    uint8_t state[KEYPAD_LINES_MAX * KEYPAD_LINES_MAX];
+} keypad_t;
+
+// Activer toutes les rangées (repos) ou une seule (balayage), une rangée inactive
+// (1) est libérée par le drain ouvert
+static int keypad_drive(keypad_t *kp, int row) {
+    int values[KEYPAD_LINES_MAX];
+    for (int r = 0; r < kp->rows.count; r++) {
+        values[r] = (row < 0 || r == row) ? 0 : 1;
+    }
+    return bulk_set_values(&kp->rows, values);
+}
+
+// Descripteurs des fronts des colonnes (un par requête en v2, un par ligne en v1)
+static int keypad_event_fds(keypad_t *kp, struct pollfd *pfds) {
+#ifdef LIBGPIOD_V2
+    pfds[0].fd = gpiod_line_request_get_fd(kp->cols.request);
+    pfds[0].events = POLLIN;
+    return 1;
+#else
+    for (int c = 0; c < kp->cols.count; c++) {
+        pfds[c].fd = gpiod_line_event_get_fd(gpiod_line_bulk_get_line(&kp->cols.bulk, c));
+        pfds[c].events = POLLIN;
+    }
+    return kp->cols.count;
+#endif
+}
+
+// Vider les fronts accumulés pendant le balayage, seul le niveau des colonnes compte
+static void keypad_drain(keypad_t *kp, struct pollfd *pfds, int nfds, void *buffer) {
+    for (int i = 0; i < nfds; i++) {
+        pfds[i].revents = 0;
+        while (poll(&pfds[i], 1, 0) > 0 && (pfds[i].revents & POLLIN)) {
+#ifdef LIBGPIOD_V2
+            if (gpiod_line_request_read_edge_events(kp->cols.request, (struct gpiod_edge_event_buffer*)buffer, GPIO_EVENT_BATCH) <= 0) break;
+#else
+            if (gpiod_line_event_read_multiple(gpiod_line_bulk_get_line(&kp->cols.bulk, i),
+                    (struct gpiod_line_event*)buffer, GPIO_EVENT_BATCH) <= 0) break;
+#endif
+        }
+    }
+}
+
+// Balayer la matrice une fois, retourne 1 tant qu'une touche est enfoncée ou non stabilisée
+static int keypad_scan(keypad_t *kp) {
+    int busy = 0;
+    int cols[KEYPAD_LINES_MAX];
+    struct timespec settle = { 0, KEYPAD_SETTLE_NS };
+
+    for (int r = 0; r < kp->rows.count; r++) {
+        keypad_drive(kp, r);
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &settle, NULL);
+        if (bulk_get_values(&kp->cols, cols) < 0) continue;
+        uint64_t now = monotonic_ns();
+
+        for (int c = 0; c < kp->cols.count; c++) {
+            int key = r * kp->cols.count + c;
+
+            // Intégrateur par touche: enfoncée quand la colonne est à 0
+            if (!cols[c]) {
+                if (kp->counter[key] < kp->debounce) kp->counter[key]++;
+            } else if (kp->counter[key] > 0) {
+                kp->counter[key]--;
+            }
+
+            int change = kp->state[key] ? kp->counter[key] == 0 : kp->counter[key] == kp->debounce;
+            if (change) {
+                kp->state[key] = !kp->state[key];
+                if (kp->tsfn) {
+                    keypad_event_t *data = (keypad_event_t*)malloc(sizeof(keypad_event_t));
+                    if (data) {
+                        data->key = key;
+                        data->down = kp->state[key];
+                        data->timestamp_ns = now;
+                        napi_call_threadsafe_function(kp->tsfn, data, napi_tsfn_nonblocking);
+                    }
+                }
+            }
+            if (kp->state[key] || kp->counter[key]) busy = 1;
+        }
+    }
+    return busy;
+}
+
+// Thread du clavier: au repos, attente d'un front sur une colonne; balayage tant qu'une touche est active
+static void* keypad_thread_func(void* arg) {
+    keypad_t *kp = (keypad_t*)arg;
+    struct pollfd pfds[KEYPAD_LINES_MAX + 1];
+    int nfds = keypad_event_fds(kp, pfds);
+    pfds[nfds].fd = kp->wake_fd;
+    pfds[nfds].events = POLLIN;
+
+#ifdef LIBGPIOD_V2
+    struct gpiod_edge_event_buffer *buffer = gpiod_edge_event_buffer_new(GPIO_EVENT_BATCH);
+    if (!buffer) return NULL;
+#else
+    struct gpiod_line_event buffer[GPIO_EVENT_BATCH];
+#endif
+
+    while (kp->running) {
+        // Repos: toutes les rangées actives, une touche enfoncée met sa colonne à 0
+        keypad_drive(kp, -1);
+        keypad_drain(kp, pfds, nfds, buffer);
+
+        int cols[KEYPAD_LINES_MAX];
+        int pressed = 0;
+        if (bulk_get_values(&kp->cols, cols) == 0) {
+            for (int c = 0; c < kp->cols.count; c++) {
+                if (!cols[c]) pressed = 1;
+            }
+        }
+
+        if (!pressed) {
+            for (int i = 0; i <= nfds; i++) pfds[i].revents = 0;
+            int ret = poll(pfds, nfds + 1, -1);
+            if (ret < 0 && errno == EINTR) continue;
+            if (ret < 0) break;
+            if (pfds[nfds].revents) {
+                uint64_t count;
+                if (read(kp->wake_fd, &count, sizeof(count)) < 0) {
+                    // EAGAIN: réveil déjà consommé
+                }
+                continue; // réveil: vérifier running
+            }
         }
 
-        if (ctx->tsfn) {
-            napi_release_threadsafe_function(ctx->tsfn, napi_tsfn_abort);
-            ctx->tsfn = NULL;
+        // Balayage périodique jusqu'au relâchement stable de toutes les touches
+        uint64_t next = monotonic_ns();
+        while (kp->running && keypad_scan(kp)) {
+            next += kp->interval_ns;
+            uint64_t now = monotonic_ns();
+            if (next < now) next = now;
+
+            struct timespec ts;
+            ts.tv_sec = next / 1000000000ULL;
+            ts.tv_nsec = next % 1000000000ULL;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
         }
     }
 
 #ifdef LIBGPIOD_V2
-    if (ctx->request) {
-        gpiod_line_request_release(ctx->request);
-        ctx->request = NULL;
+    gpiod_edge_event_buffer_free(buffer);
+#endif
+    return NULL;
+}
+
+// Arrêter le balayage; les événements déjà en file sont encore transmis
+static void keypad_stop(keypad_t *kp) {
+    if (kp->running) {
+        kp->running = 0;
+        uint64_t one = 1;
+        if (write(kp->wake_fd, &one, sizeof(one)) < 0) {
+            // Compteur déjà non nul: le thread sera réveillé de toute façon
+        }
+        pthread_join(kp->thread, NULL);
     }
-    if (ctx->line_settings) {
-        gpiod_line_settings_free(ctx->line_settings);
-        ctx->line_settings = NULL;
+
+    if (kp->tsfn) {
+        napi_release_threadsafe_function(kp->tsfn, napi_tsfn_release);
+        kp->tsfn = NULL;
     }
-    if (ctx->line_cfg) {
-        gpiod_line_config_free(ctx->line_cfg);
-        ctx->line_cfg = NULL;
+}
+
+static void keypad_close(keypad_t *kp) {
+    if (kp->is_closed) return;
+
+    keypad_stop(kp);
+    bulk_release(&kp->rows);
+    bulk_release(&kp->cols);
+    kp->is_closed = 1;
+}
+
+static void finalize_keypad(napi_env env, void* finalize_data, void* finalize_hint) {
+    keypad_t *kp = (keypad_t*)finalize_data;
+    if (kp) {
+        keypad_close(kp);
+        if (kp->wake_fd >= 0) {
+            close(kp->wake_fd);
+        }
+        free(kp);
     }
-    if (ctx->req_cfg) {
-        gpiod_request_config_free(ctx->req_cfg);
-        ctx->req_cfg = NULL;
+}
+
+// Lire un handle de clavier ouvert
+static keypad_t* get_keypad(napi_env env, napi_value value) {
+    keypad_t *kp = NULL;
+    napi_status status = napi_get_value_external(env, value, (void**)&kp);
+    if (status != napi_ok || kp == NULL) {
+        napi_throw_error(env, NULL, "Invalid keypad handle");
+        return NULL;
     }
-    if (ctx->chip) {
-        gpiod_chip_close(ctx->chip);
-        ctx->chip = NULL;
+    if (kp->is_closed) {
+        napi_throw_error(env, NULL, "Keypad handle has been closed");
+        return NULL;
     }
-#else
-    if (ctx->line) {
-        gpiod_line_release(ctx->line);
-        ctx->line = NULL;
+    return kp;
+}
+
+// Fonction: keypadOpen(chipName, rows, cols)
+static napi_value KeypadOpen(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    char chip_name[256];
+    unsigned int rows[KEYPAD_LINES_MAX];
+    unsigned int cols[KEYPAD_LINES_MAX];
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 3) {
+        napi_throw_error(env, NULL, "Expected chipName, rows and cols arguments");
+        return NULL;
     }
-    if (ctx->chip) {
-        gpiod_chip_close(ctx->chip);
-        ctx->chip = NULL;
+
+    if (napi_get_value_string_utf8(env, args[0], chip_name, sizeof(chip_name), NULL) != napi_ok) {
+        napi_throw_error(env, NULL, "Invalid chip name");
+        return NULL;
     }
-#endif
 
-    ctx->is_closed = 1;
+    int row_count = get_line_array(env, args[1], rows, KEYPAD_LINES_MAX);
+    int col_count = get_line_array(env, args[2], cols, KEYPAD_LINES_MAX);
+    if (row_count < 1 || col_count < 1) {
+        napi_throw_error(env, NULL, "Expected arrays of 1 to 16 distinct rows and columns");
+        return NULL;
+    }
+
+    for (int c = 0; c < col_count; c++) {
+        if (line_index(rows, row_count, cols[c]) >= 0) {
+            napi_throw_error(env, NULL, "Keypad rows and columns must be distinct lines");
+            return NULL;
+        }
+    }
+
+    keypad_t *kp = (keypad_t*)malloc(sizeof(keypad_t));
+    if (!kp) {
+        napi_throw_error(env, NULL, "Memory allocation failed");
+        return NULL;
+    }
+    memset(kp, 0, sizeof(keypad_t));
+
+    // Rangées en drain ouvert: deux touches d'une même colonne relieraient sinon
+    // une rangée active (0) à une rangée inactive (1) en court-circuit
+    int values[KEYPAD_LINES_MAX] = { 0 };
+    if (bulk_request(&kp->rows, chip_name, rows, row_count, 1, values, "open-drain", "disable", 0) < 0) {
+        free(kp);
+        napi_throw_error(env, NULL, "Failed to request keypad rows as outputs");
+        return NULL;
+    }
+
+    if (bulk_request(&kp->cols, chip_name, cols, col_count, 0, NULL, NULL, "pull-up", 1) < 0) {
+        bulk_release(&kp->rows);
+        free(kp);
+        napi_throw_error(env, NULL, "Failed to request keypad columns as inputs");
+        return NULL;
+    }
+
+    kp->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (kp->wake_fd < 0) {
+        bulk_release(&kp->rows);
+        bulk_release(&kp->cols);
+        free(kp);
+        napi_throw_error(env, NULL, "Failed to create wakeup eventfd");
+        return NULL;
+    }
+
+    napi_value external;
+    status = napi_create_external(env, kp, finalize_keypad, NULL, &external);
+    if (status != napi_ok) {
+        finalize_keypad(env, kp, NULL);
+        napi_throw_error(env, NULL, "Failed to create external");
+        return NULL;
+    }
+
+    return external;
+}
+
+// Touche appelée depuis le thread JavaScript: callback(key, down, timestamp)
+static void call_js_keypad(napi_env env, napi_value js_callback, void* context, void* data) {
+    if (data == NULL) {
+        return;
+    }
+
+    keypad_event_t *event = (keypad_event_t*)data;
+
+    if (env != NULL && js_callback != NULL) {
+        napi_value argv[3];
+        napi_status status = napi_create_int32(env, event->key, &argv[0]);
+
+        if (status == napi_ok) {
+            status = napi_get_boolean(env, event->down, &argv[1]);
+        }
+
+        if (status == napi_ok) {
+            status = napi_create_bigint_uint64(env, event->timestamp_ns, &argv[2]);
+        }
+
+        if (status == napi_ok) {
+            napi_value global;
+            status = napi_get_global(env, &global);
+
+            if (status == napi_ok) {
+                napi_value result;
+                napi_call_function(env, global, js_callback, 3, argv, &result);
+            }
+        }
+    }
+
+    free(data);
+}
+
+// Fonction: keypadStart(handle, intervalUs, debounce, callback) - debounce en balayages
+static napi_value KeypadStart(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    int interval_us, debounce;
+    napi_valuetype type;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (status != napi_ok || argc < 4) {
+        napi_throw_error(env, NULL, "Expected handle, interval, debounce and callback arguments");
+        return NULL;
+    }
+
+    keypad_t *kp = get_keypad(env, args[0]);
+    if (!kp) return NULL;
+
+    if (kp->running) {
+        napi_throw_error(env, NULL, "Keypad already started");
+        return NULL;
+    }
+
+    if (napi_get_value_int32(env, args[1], &interval_us) != napi_ok ||
+        napi_get_value_int32(env, args[2], &debounce) != napi_ok ||
+        interval_us < KEYPAD_INTERVAL_MIN_US || debounce < 1 || debounce > KEYPAD_DEBOUNCE_MAX) {
+        napi_throw_error(env, NULL, "Invalid keypad interval or debounce");
+        return NULL;
+    }
+
+    if (napi_typeof(env, args[3], &type) != napi_ok || type != napi_function) {
+        napi_throw_error(env, NULL, "Keypad callback must be a function");
+        return NULL;
+    }
+
+    napi_value resource_name;
+    napi_create_string_utf8(env, "GPIOKeypad", NAPI_AUTO_LENGTH, &resource_name);
+    status = napi_create_threadsafe_function(env, args[3], NULL, resource_name, 0, 1,
+        NULL, NULL, NULL, call_js_keypad, &kp->tsfn);
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Failed to create threadsafe function");
+        return NULL;
+    }
+
+    // Toutes les touches relâchées au démarrage
+    memset(kp->counter, 0, sizeof(kp->counter));
+    memset(kp->state, 0, sizeof(kp->state));
+    kp->interval_ns = (uint64_t)interval_us * 1000ULL;
+    kp->debounce = debounce;
+
+    uint64_t count;
+    if (read(kp->wake_fd, &count, sizeof(count)) < 0) {
+        // EAGAIN: aucun réveil en attente
+    }
+
+    kp->running = 1;
+    if (pthread_create(&kp->thread, NULL, keypad_thread_func, kp) != 0) {
+        kp->running = 0;
+        keypad_stop(kp);
+        napi_throw_error(env, NULL, "Failed to create keypad thread");
+        return NULL;
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fonction: keypadStop(handle)
+static napi_value KeypadStop(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    keypad_t *kp = argc >= 1 ? get_keypad(env, args[0]) : NULL;
+    if (!kp) return NULL;
+
+    keypad_stop(kp);
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Fonction: keypadClose(handle)
+static napi_value KeypadClose(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    keypad_t *kp = NULL;
+
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    if (argc >= 1 && napi_get_value_external(env, args[0], (void**)&kp) == napi_ok && kp) {
+        keypad_close(kp);
+    }
 
     napi_value result;
     napi_get_undefined(env, &result);
@@ -844,6 +4701,31 @@ static napi_value Init(napi_env env, napi_value exports) {
         napi_set_named_property(env, exports, "openInput", fn);
     }
 
+    status = napi_create_function(env, NULL, 0, OpenReplay, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "openReplay", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, RecordStart, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "recordStart", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, RecordStop, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "recordStop", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, ReplayStart, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "replayStart", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, ReplayStop, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "replayStop", fn);
+    }
+
     status = napi_create_function(env, NULL, 0, Write, NULL, &fn);
     if (status == napi_ok) {
         napi_set_named_property(env, exports, "write", fn);
@@ -864,11 +4746,156 @@ static napi_value Init(napi_env env, napi_value exports) {
         napi_set_named_property(env, exports, "stopMonitoring", fn);
     }
 
+    status = napi_create_function(env, NULL, 0, MonitoringStats, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "monitoringStats", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, PulseMeasure, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "pulseMeasure", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, PulseMeasureAsync, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "pulseMeasureAsync", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, StartRanging, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "startRanging", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, StopRanging, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "stopRanging", fn);
+    }
+
     status = napi_create_function(env, NULL, 0, Close, NULL, &fn);
     if (status == napi_ok) {
         napi_set_named_property(env, exports, "close", fn);
     }
 
+    status = napi_create_function(env, NULL, 0, CloseAsync, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "closeAsync", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, ReflexAdd, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "reflexAdd", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, ReflexRemove, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "reflexRemove", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, ReflexReset, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "reflexReset", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, PwmOpen, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "pwmOpen", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, PwmWrite, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "pwmWrite", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, PwmMove, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "pwmMove", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, PwmCancel, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "pwmCancel", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, PwmClose, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "pwmClose", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, StepperOpen, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "stepperOpen", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, StepperMove, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "stepperMove", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, StepperStop, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "stepperStop", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, StepperPosition, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "stepperPosition", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, StepperClose, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "stepperClose", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, SamplerOpen, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "samplerOpen", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, SamplerStart, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "samplerStart", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, SamplerStop, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "samplerStop", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, SamplerValues, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "samplerValues", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, SamplerRead, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "samplerRead", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, SamplerClose, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "samplerClose", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, KeypadOpen, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "keypadOpen", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, KeypadStart, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "keypadStart", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, KeypadStop, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "keypadStop", fn);
+    }
+
+    status = napi_create_function(env, NULL, 0, KeypadClose, NULL, &fn);
+    if (status == napi_ok) {
+        napi_set_named_property(env, exports, "keypadClose", fn);
+    }
+
     return exports;
 }
 
@@ -8,7 +8,8 @@
       ],
       "libraries": [
         "-lgpiod",
-        "-lpthread"
+        "-lpthread",
+        "-lm"
       ],
       "cflags": [
         "-Wall",
@@ -24,7 +25,8 @@
         ["OS=='linux'", {
           "libraries": [
             "-lgpiod",
-            "-lpthread"
+            "-lpthread",
+            "-lm"
           ]
         }]
       ]
@@ -16,13 +16,18 @@ export const sleep = (ms, track = true) => {
 
 /** ------------------------------------------------------------------
  * @function ctrlC
- * @description Intercept ctrl+c then exec callback
+ * @description Intercept ctrl+c then exec callback and exit
+ *              once the promise it returns, if any, is settled
  * @param {Function} callback
  */
 export const ctrlC = callback => {
-    process.on("SIGINT", () => {
+    process.on("SIGINT", async () => {
         log("ctrl+c pressed")
-        typeof callback === "function" ? callback() : false
+        try {
+            typeof callback === "function" ? await callback() : false
+        } catch (err) {
+            warn("ctrl+c callback error:", err)
+        }
         process.exit(0)
     })
 }
@@ -19,6 +19,9 @@ const RPi_GPIO_PWM = [12, 13, 18, 19]
 const RPI_GPIO_ALL = [...RPi_GPIO_STD, ...RPi_GPIO_PWM]
 const RPI_CHIP = "gpiochip0"
 const PWM_CHIP = "pwmchip0"
+const MULTI_LINE_MODES = ["stepper", "sampler", "keypad"]
+const REFLEX_EDGES = ["falling", "rising", "both"] // index is the addon edge code
+const PRIORITIES = ["high", "normal", "low"] // index is the addon delivery class
 
 // -------------------------------------------------------------------
 // CLASS RIO & METHODS
@@ -33,8 +36,8 @@ export class RIO {
 
     /** ------------------------------------------------------------------
      * @method constructor
-     * @param {Number} line - BCM number
-     * @param {String} mode - "input", "output", "pwm"
+     * @param {Number|Array} line - BCM number, array of BCM numbers for multi-line modes
+     * @param {String} mode - "input", "output", "pwm", "stepper", "sampler", "keypad"
      * @param {Object} opt - misc options depending on mode
      */
     constructor(line, mode, opt) {
@@ -42,33 +45,59 @@ export class RIO {
         const defopt = {
             // output
             value: 0, // Initial value
-            // input, output
+            // input, output, sampler
             bias: "disable", // "disable", "pull-up", "pull-down"
+            // input
+            replay: false, // Virtual line fed by RIO.replay() instead of hardware
             // pwm
             exportTime: -1,
             period: 20000, // μs ~50Hz
             dutyMin: 0, // μs
-            dutyMax: 20000 // µs
+            dutyMax: 20000, // µs
+            // stepper
+            enableLevel: 0, // Active level of ENABLE line, 0 for most drivers (A4988, DRV8825, TMC2208)
+            realtime: true, // Step thread with SCHED_FIFO priority when allowed (root or CAP_SYS_NICE)
+            // keypad
+            rows: 0, // Number of row lines at the beginning of the array, half of the lines by default
+            keys: null // Key labels in row-major order e.g. "123A456B789C*0#D", key index by default
         }
         opt = {...defopt, ...opt}
 
-        if (RPI_GPIO_ALL.indexOf(line) === -1)
-            throw new Error("This line is not supported: " + line)
+        // Multi-line modes own several lines e.g. stepper [step, dir, enable]
+        const lines = Array.isArray(line) ? line : [line]
+        if (Array.isArray(line) && MULTI_LINE_MODES.indexOf(mode) === -1)
+            throw new Error("Array of lines is not supported in mode: " + mode)
 
-        // line is already defined
-        if (RIO.instances.has(line))
-            throw new Error("This line is already defined: " + line)
+        for (const [i, l] of lines.entries()) {
+            if (RPI_GPIO_ALL.indexOf(l) === -1)
+                throw new Error("This line is not supported: " + l)
+
+            // line appears twice in the array
+            if (lines.indexOf(l) !== i)
+                throw new Error("This line is used twice: " + l)
+
+            // line is already defined
+            if (RIO.instances.has(l))
+                throw new Error("This line is already defined: " + l)
+        }
 
         this.line = line
+        this.lines = lines
         this.handle = null
         this.mode = mode
         this.value = opt.value
         this.bias = opt.bias
         this.closed = false // Instance status
         this.monitoring = false // Monitoring status
-        this.config = lineConfig(this.line) // Required for pwm
+        this.ranging = false // Continuous pulse measurement status
+        this.replay = mode === "input" && opt.replay
+        this.config = this.replay || lines.length > 1 ? "" : lineConfig(this.line) // Required for pwm
         this.pwmExported = false
         this.pwmEnabled = false
+        this.pwmHandle = null // Native duty cycle writer and motion engine
+        this.stepperHandle = null // Native step pulse generator
+        this.samplerHandle = null // Native fixed-rate sampler
+        this.keypadHandle = null // Native matrix scanner
         // Define exportTime when defined to automatic by default
         if (opt.exportTime === -1) {
             switch (RIO.model()) {
@@ -95,7 +124,7 @@ export class RIO {
                 this.handle = ADDON.openOutput(CHIPNAME, line, this.value, opt.bias)
                 break
             case "input":
-                this.handle = ADDON.openInput(CHIPNAME, line, opt.bias)
+                this.handle = this.replay ? ADDON.openReplay(line) : ADDON.openInput(CHIPNAME, line, opt.bias)
                 break
             case "pwm":
                 if (RPi_GPIO_PWM.indexOf(line) === -1)
@@ -130,6 +159,7 @@ export class RIO {
                     writeFileSync(this.pwmPathChannel + "duty_cycle", String(this.dutyMin))
                     writeFileSync(this.pwmPathChannel + "enable", "1")
                     this.pwmEnabled = true
+                    this.pwmHandle = ADDON.pwmOpen(this.pwmPathChannel + "duty_cycle", this.dutyMin)
 
                 } catch (err) {
                     warn("pwm start error:", err)
@@ -138,12 +168,32 @@ export class RIO {
                 }
 
                 break
+            case "stepper":
+                if (lines.length < 2 || lines.length > 3)
+                    throw new Error("Stepper lines expected: [step, dir] or [step, dir, enable]")
+
+                this.stepperHandle = ADDON.stepperOpen(CHIPNAME, lines, opt.enableLevel ? 1 : 0, Boolean(opt.realtime))
+                break
+            case "sampler":
+                this.samplerHandle = ADDON.samplerOpen(CHIPNAME, lines, opt.bias)
+                break
+            case "keypad": {
+                const rows = opt.rows || Math.floor(lines.length / 2)
+                if (rows < 1 || rows >= lines.length || rows > 16 || lines.length - rows > 16)
+                    throw new Error("Keypad lines expected: [...rows, ...cols] with 1 to 16 rows and columns")
+
+                this.keypadRows = lines.slice(0, rows)
+                this.keypadCols = lines.slice(rows)
+                this.keypadKeys = opt.keys
+                this.keypadHandle = ADDON.keypadOpen(CHIPNAME, this.keypadRows, this.keypadCols)
+                break
+            }
             default:
                 throw new Error("undefined mode")
         }
 
         // Everything OK => Add this to instance list
-        RIO.instances.set(line, this)
+        lines.forEach(l => RIO.instances.set(l, this))
     }
 
     /** ------------------------------------------------------------------
@@ -161,6 +211,10 @@ export class RIO {
         if (this.monitoring)
             this.monitoringStop()
 
+        // Stop ranging if active
+        if (this.ranging)
+            this.rangingStop()
+
         // Free C resources and reset handle
         if (this.handle) {
             ADDON.close(this.handle)
@@ -171,12 +225,80 @@ export class RIO {
         if (this.mode === "pwm")
             this.pwmStop()
 
+        // Stop stepper thread and release its lines
+        if (this.stepperHandle) {
+            ADDON.stepperClose(this.stepperHandle)
+            this.stepperHandle = null
+        }
+
+        // Stop sampler thread and release its lines
+        if (this.samplerHandle) {
+            ADDON.samplerClose(this.samplerHandle)
+            this.samplerHandle = null
+        }
+
+        // Stop keypad thread and release its lines
+        if (this.keypadHandle) {
+            ADDON.keypadClose(this.keypadHandle)
+            this.keypadHandle = null
+        }
+
         // Delete from instance list et reset flag
-        RIO.instances.delete(this.line)
+        this.lines.forEach(l => RIO.instances.delete(l))
         this.closed = true
         log("line", this.line, "is closed")
     }
 
+    /** ------------------------------------------------------------------
+     * @method closeAsync
+     * @description Close instance without blocking the event loop:
+     *              monitoring and ranging threads are joined by the addon
+     * @return {Promise} resolved when the line is released
+     */
+    async closeAsync() {
+        if (this.closed) {
+            warn("this instance is already closed")
+            return
+        }
+
+        // Instance is unusable from now on
+        const handle = this.handle
+        this.handle = null
+        this.monitoring = false
+        this.ranging = false
+        this.rangingTrigger = null
+        this.closed = true
+        this.lines.forEach(l => RIO.instances.delete(l))
+
+        // Stop PWM if required
+        if (this.mode === "pwm")
+            this.pwmStop()
+
+        // Stop stepper thread and release its lines
+        if (this.stepperHandle) {
+            ADDON.stepperClose(this.stepperHandle)
+            this.stepperHandle = null
+        }
+
+        // Stop sampler thread and release its lines
+        if (this.samplerHandle) {
+            ADDON.samplerClose(this.samplerHandle)
+            this.samplerHandle = null
+        }
+
+        // Stop keypad thread and release its lines
+        if (this.keypadHandle) {
+            ADDON.keypadClose(this.keypadHandle)
+            this.keypadHandle = null
+        }
+
+        // Free C resources
+        if (handle)
+            await ADDON.closeAsync(handle)
+
+        log("line", this.line, "is closed")
+    }
+
     /** ------------------------------------------------------------------
      * @method write
      * @description Write value to GPIO line
@@ -214,11 +336,13 @@ export class RIO {
     /** ------------------------------------------------------------------
      * @method monitoringStart
      * @description Monitor input GPIO line events (rising/falling)
-     * @param {Function} callback 0,1
+     * @param {Function} callback (edge, time) with kernel timestamp in ns (BigInt)
      * @param {String} edge
      * @param {Number} bounce
+     * @param {Object} opt - priority ("high", "normal", "low"), weight within priority, rate cap (events/s)
      */
-    monitoringStart(callback, edge = "both", bounce = 0) {
+    monitoringStart(callback, edge = "both", bounce = 0, opt) {
+        opt = {priority: "normal", weight: 1, rate: 0, ...opt}
         if (this.closed)
             throw new Error("GPIO handle has been closed")
 
@@ -228,34 +352,45 @@ export class RIO {
         if (this.monitoring)
             throw new Error("Monitoring already started")
 
+        const priority = PRIORITIES.indexOf(opt.priority)
+        if (priority === -1)
+            throw new Error("Monitoring priority must be one of: " + PRIORITIES.join(", "))
+
+        if (!Number.isInteger(opt.weight) || opt.weight < 1 || opt.weight > 100)
+            throw new Error("Monitoring weight is out of range (1 - 100)")
+
+        if (typeof opt.rate !== "number" || opt.rate < 0)
+            throw new Error("Monitoring rate must be a positive number of events/s, 0 for no cap")
+
         bounce < 0 ? bounce = 0 : false
         bounce > 1000 ? bounce = 1000 : false
         this.latestEvent = {
-            time: new Date(null),
+            time: null, // kernel timestamp in ns
             edge: "none"
         }
+        const bounceNs = BigInt(Math.round(bounce * 1000000))
 
-        ADDON.startMonitoring(this.handle, value => {
+        ADDON.startMonitoring(this.handle, (value, time) => {
             const evt = value === 1 ? "rising" : "falling"
-            const now = new Date()
-            const delta = Math.max(1, now - this.latestEvent.time) // delta is always > 0ms
+            // Delivery is bursty (queues, priorities, rate caps, fast replay): compare kernel timestamps
+            const delta = this.latestEvent.time === null ? null : time - this.latestEvent.time
 
             // Bounce detected
-            if (delta <= bounce && evt === this.latestEvent.edge) {
-                log("bounce detected on gpio", this.line, evt, delta + "ms")
+            if (bounceNs > 0n && delta !== null && delta <= bounceNs && evt === this.latestEvent.edge) {
+                log("bounce detected on gpio", this.line, evt, (Number(delta) / 1000000).toFixed(3) + "ms")
             }
             // Callback of required events
             else {
                 if (typeof callback === "function" && (edge === "both" || edge === evt)) {
-                    callback(evt)
+                    callback(evt, time)
                 }
             }
             // Update latest event
             this.latestEvent = {
-                time: now,
+                time: time,
                 edge: evt
             }
-        })
+        }, priority, opt.weight, opt.rate)
         this.monitoring = true
     }
 
@@ -273,6 +408,174 @@ export class RIO {
         }
     }
 
+    /** ------------------------------------------------------------------
+     * @method monitoringStats
+     * @description Return event delivery counters since monitoringStart
+     * @return {Object} delivered, throttled (rate cap or full queue) and pending events
+     */
+    monitoringStats() {
+        if (this.closed)
+            throw new Error("GPIO handle has been closed")
+
+        if (this.mode !== "input")
+            throw new Error("Cannot monitor this GPIO mode:", this.mode)
+
+        return ADDON.monitoringStats(this.handle)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method reflexAdd
+     * @description Write a value on an output as soon as this input changes,
+     *              from the native event thread without waiting for JavaScript
+     * @param {RIO} output - output instance
+     * @param {Object} opt - edge, value, latch (once until reflexReset), delay (ms)
+     * @param {Function} callback (edge, time, actionTime) with timestamps in ns (BigInt)
+     * @return {Number} rule id
+     */
+    reflexAdd(output, opt, callback) {
+        opt = {edge: "rising", value: 0, latch: false, delay: 0, ...opt}
+
+        if (this.closed)
+            throw new Error("GPIO handle has been closed")
+
+        if (this.mode !== "input")
+            throw new Error("Cannot add reflex on this GPIO mode:", this.mode)
+
+        if (!(output instanceof RIO) || output.mode !== "output" || output.closed)
+            throw new Error("Reflex output must be an open output instance")
+
+        const edge = REFLEX_EDGES.indexOf(opt.edge)
+        if (edge === -1)
+            throw new Error("Reflex edge must be one of: " + REFLEX_EDGES.join(", "))
+
+        if ([0, 1].indexOf(opt.value) === -1)
+            throw new Error("Value must be either 0 or 1")
+
+        const delay = Math.max(0, Math.round(opt.delay * 1000))
+        const notify = typeof callback === "function"
+            ? (value, time, actionTime) => callback(value === 1 ? "rising" : "falling", time, actionTime)
+            : null
+
+        return ADDON.reflexAdd(this.handle, output.handle, edge, opt.value, !!opt.latch, delay, notify)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method reflexRemove
+     * @description Remove a reflex rule
+     * @param {Number} id
+     * @return {Boolean} false if the rule does not exist
+     */
+    reflexRemove(id) {
+        return ADDON.reflexRemove(id)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method reflexReset
+     * @description Re-arm a latched reflex rule
+     * @param {Number} id
+     * @return {Boolean} false if the rule does not exist
+     */
+    reflexReset(id) {
+        return ADDON.reflexReset(id)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method pulseMeasure
+     * @description Send a trigger pulse then measure width of the high pulse
+     *              on this input, e.g. echo of an ultrasonic sensor HC-SR04
+     * @param {RIO} trigger - output instance
+     * @param {Object} opt - pulse: trigger pulse (µs), timeout: max wait for echo (ms)
+     * @return {Number} pulse width in ns, -1 on timeout
+     */
+    pulseMeasure(trigger, opt) {
+        const args = this.pulseArgs(trigger, opt)
+        return ADDON.pulseMeasure(...args)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method pulseMeasureAsync
+     * @description Same as pulseMeasure without blocking the event loop
+     * @param {RIO} trigger - output instance
+     * @param {Object} opt - pulse: trigger pulse (µs), timeout: max wait for echo (ms)
+     * @return {Promise<Number>} pulse width in ns, -1 on timeout
+     */
+    pulseMeasureAsync(trigger, opt) {
+        const args = this.pulseArgs(trigger, opt)
+        return ADDON.pulseMeasureAsync(...args)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method rangingStart
+     * @description Continuous pulse measurement at fixed interval
+     * @param {RIO} trigger - output instance
+     * @param {Function} callback (width, error) width in ns, -1 on timeout.
+     *                   When the trigger is closed or a read fails, ranging stops and
+     *                   the callback receives (null, Error)
+     * @param {Object} opt - pulse (µs), timeout (ms), interval (ms)
+     */
+    rangingStart(trigger, callback, opt) {
+        opt = {interval: 60, ...opt}
+        const args = this.pulseArgs(trigger, opt)
+
+        if (this.ranging)
+            throw new Error("Ranging already started")
+
+        if (typeof callback !== "function")
+            throw new Error("Ranging callback must be a function")
+
+        ADDON.startRanging(...args, Math.max(1, Math.round(opt.interval)), width => {
+            // Native thread stopped on error (-2): release it before reporting
+            if (width < -1) {
+                this.rangingStop()
+                callback(null, new Error("Ranging stopped: trigger closed or read error"))
+                return
+            }
+            callback(width)
+        })
+        this.ranging = true
+        this.rangingTrigger = trigger // Keep trigger alive while ranging
+    }
+
+    /** ------------------------------------------------------------------
+     * @method rangingStop
+     * @description Stop continuous pulse measurement
+     */
+    rangingStop() {
+        if (this.closed)
+            return
+
+        if (this.ranging) {
+            ADDON.stopRanging(this.handle)
+            this.ranging = false
+            this.rangingTrigger = null
+        }
+    }
+
+    /** ------------------------------------------------------------------
+     * @method pulseArgs
+     * @description Check and return addon arguments of pulse measurement
+     * @param {RIO} trigger
+     * @param {Object} opt
+     * @return {Array}
+     */
+    pulseArgs(trigger, opt) {
+        opt = {pulse: 10, timeout: 60, ...opt}
+
+        if (this.closed)
+            throw new Error("GPIO handle has been closed")
+
+        if (this.mode !== "input")
+            throw new Error("Cannot measure pulse on this GPIO mode:", this.mode)
+
+        if (!(trigger instanceof RIO) || trigger.mode !== "output" || trigger.closed)
+            throw new Error("Trigger must be an open output instance")
+
+        if (this.monitoring)
+            throw new Error("Cannot measure pulse while monitoring")
+
+        return [trigger.handle, this.handle, Math.round(opt.pulse), Math.round(opt.timeout)]
+    }
+
     /** --------------------------------------------------------------
      * @method pwmStop
      * @description Stop PWM modulation
@@ -282,6 +585,12 @@ export class RIO {
         if (this.mode !== "pwm")
             throw new Error("This line is not configured as PWM")
 
+        // Cancel motion if any and release duty cycle writer
+        if (this.pwmHandle) {
+            ADDON.pwmClose(this.pwmHandle)
+            this.pwmHandle = null
+        }
+
         if (this.pwmEnabled) {
             writeFileSync(this.pwmPathChannel + "enable", "0")
             this.pwmEnabled = false
@@ -295,10 +604,42 @@ export class RIO {
 
     /** --------------------------------------------------------------
      * @method pwmDuty
-     * @description Change PWM duty cycle
+     * @description Change PWM duty cycle, cancel motion in progress if any
      * @param {Number} percent 0 <= percent  <= 100
      */
     pwmDuty(percent) {
+        const duty = this.pwmDutyNs(percent)
+        this.pwmHandle ? ADDON.pwmWrite(this.pwmHandle, duty) : writeFileSync(this.pwmPathChannel + "duty_cycle", String(duty))
+    }
+
+    /** --------------------------------------------------------------
+     * @method pwmMove
+     * @description Ramp PWM duty cycle to target from a native thread
+     * @param {Number} percent target 0 <= percent  <= 100
+     * @param {Number} duration ms
+     * @param {Object} opt - profile: "linear", "trapezoidal", "s-curve", rate: updates per second
+     * @return {Promise<Boolean>} true when target is reached, false if cancelled
+     */
+    pwmMove(percent, duration, opt) {
+        return RIO.pwmMoveAll([[this, percent]], duration, opt)
+    }
+
+    /** --------------------------------------------------------------
+     * @method pwmCancel
+     * @description Stop PWM motion at current duty cycle
+     */
+    pwmCancel() {
+        if (this.pwmHandle)
+            ADDON.pwmCancel(this.pwmHandle)
+    }
+
+    /** --------------------------------------------------------------
+     * @method pwmDutyNs
+     * @description Check PWM line and convert duty percent to ns
+     * @param {Number} percent 0 <= percent  <= 100
+     * @return {Number}
+     */
+    pwmDutyNs(percent) {
 
         if (this.mode !== "pwm")
             throw new Error("This line is not configured as PWM")
@@ -310,7 +651,188 @@ export class RIO {
             throw new Error("Duty value (%) of PWM line" + this.line + " is not valid")
         }
 
-        writeFileSync(this.pwmPathChannel + "duty_cycle", (this.dutyMin + ((percent / 100) * (this.dutyMax - this.dutyMin))).toString())
+        return Math.round(this.dutyMin + ((percent / 100) * (this.dutyMax - this.dutyMin)))
+    }
+
+    /** ------------------------------------------------------------------
+     * @method stepperMove
+     * @description Move stepper motor with acceleration/deceleration ramps
+     * @param {Number} steps - relative move, negative for reverse direction
+     * @param {Number} speed - max speed (steps/s)
+     * @param {Number} accel - acceleration and deceleration (steps/s²), 0 for constant speed
+     * @return {Promise<Boolean>} true when move is complete, false if stopped
+     */
+    stepperMove(steps, speed, accel = 0) {
+        if (this.mode !== "stepper")
+            throw new Error("This line is not configured as stepper")
+
+        if (this.closed)
+            throw new Error("GPIO handle has been closed")
+
+        if (!Number.isInteger(steps))
+            throw new Error("Number of steps must be an integer")
+
+        if (typeof speed !== "number" || speed <= 0 || speed > 50000)
+            throw new Error("Stepper speed is out of range (0 - 50000 steps/s)")
+
+        if (typeof accel !== "number" || accel < 0)
+            throw new Error("Stepper acceleration is not valid")
+
+        return ADDON.stepperMove(this.stepperHandle, steps, speed, accel)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method stepperStop
+     * @description Stop move in progress with deceleration ramp
+     * @param {Boolean} hard - stop immediately (steps may be lost at high speed)
+     */
+    stepperStop(hard = false) {
+        if (this.mode !== "stepper")
+            throw new Error("This line is not configured as stepper")
+
+        if (this.closed)
+            return
+
+        ADDON.stepperStop(this.stepperHandle, hard)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method stepperPosition
+     * @description Return position (steps) updated at each step, or define it when idle e.g. after homing
+     * @param {Number} position - optional new position
+     * @return {Number}
+     */
+    stepperPosition(position) {
+        if (this.mode !== "stepper")
+            throw new Error("This line is not configured as stepper")
+
+        if (this.closed)
+            throw new Error("GPIO handle has been closed")
+
+        return position === undefined ? ADDON.stepperPosition(this.stepperHandle) : ADDON.stepperPosition(this.stepperHandle, position)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method samplerStart
+     * @description Read all lines at a fixed rate from a native thread, one bulk read per tick.
+     *              Stable changes are reported after integrator filtering, or raw samples
+     *              are stored in a ring buffer read with samplerRead()
+     * @param {Function} callback (line, value, time) with time in ns (BigInt), filter mode only
+     * @param {Object} opt - rate (Hz), filter (samples), buffer (raw samples, 0 for filter mode),
+     *                        realtime (SCHED_FIFO thread when allowed, true by default)
+     */
+    samplerStart(callback, opt) {
+        opt = {rate: 1000, filter: 5, buffer: 0, realtime: true, ...opt}
+
+        if (this.mode !== "sampler")
+            throw new Error("This line is not configured as sampler")
+
+        if (this.closed)
+            throw new Error("GPIO handle has been closed")
+
+        if (!Number.isInteger(opt.rate) || opt.rate < 1 || opt.rate > 50000)
+            throw new Error("Sampler rate is out of range (1 - 50000 Hz)")
+
+        if (!Number.isInteger(opt.filter) || opt.filter < 1 || opt.filter > 255)
+            throw new Error("Sampler filter is out of range (1 - 255 samples)")
+
+        if (!Number.isInteger(opt.buffer) || opt.buffer < 0 || opt.buffer > 1048576)
+            throw new Error("Sampler buffer is out of range (0 - 1048576 samples)")
+
+        const notify = typeof callback === "function"
+            ? (index, value, time) => callback(this.lines[index], value, time)
+            : null
+
+        ADDON.samplerStart(this.samplerHandle, opt.rate, opt.filter, opt.buffer, notify, Boolean(opt.realtime))
+    }
+
+    /** ------------------------------------------------------------------
+     * @method samplerStop
+     * @description Stop sampling, raw samples remain readable until next start
+     */
+    samplerStop() {
+        if (this.mode !== "sampler")
+            throw new Error("This line is not configured as sampler")
+
+        if (this.closed)
+            return
+
+        ADDON.samplerStop(this.samplerHandle)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method samplerValues
+     * @description Return filtered (stable) values of the lines
+     * @return {Array} 0,1 in the order of the lines
+     */
+    samplerValues() {
+        if (this.mode !== "sampler")
+            throw new Error("This line is not configured as sampler")
+
+        if (this.closed)
+            throw new Error("GPIO handle has been closed")
+
+        const bits = ADDON.samplerValues(this.samplerHandle)
+        return this.lines.map((l, i) => (bits >>> i) & 1)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method samplerRead
+     * @description Return raw samples stored since previous call (buffer mode)
+     * @return {Object} values (Uint32Array, bit i for line i), times (BigUint64Array, ns),
+     *                  dropped (buffer full) and missed (late ticks) since start
+     */
+    samplerRead() {
+        if (this.mode !== "sampler")
+            throw new Error("This line is not configured as sampler")
+
+        if (this.closed)
+            throw new Error("GPIO handle has been closed")
+
+        return ADDON.samplerRead(this.samplerHandle)
+    }
+
+    /** ------------------------------------------------------------------
+     * @method keypadStart
+     * @description Scan keypad matrix from a native thread: idle until a column edge,
+     *              then periodic scan with per-key debounce until all keys are released
+     * @param {Function} callback (key, event, time) with event "down" or "up", time in ns (BigInt)
+     * @param {Object} opt - interval (ms) between 2 scans, debounce (ms)
+     */
+    keypadStart(callback, opt) {
+        opt = {interval: 2, debounce: 20, ...opt}
+
+        if (this.mode !== "keypad")
+            throw new Error("This line is not configured as keypad")
+
+        if (this.closed)
+            throw new Error("GPIO handle has been closed")
+
+        if (typeof callback !== "function")
+            throw new Error("Keypad callback must be a function")
+
+        if (typeof opt.interval !== "number" || opt.interval < 0.1)
+            throw new Error("Keypad scan interval must be at least 0.1 ms")
+
+        const debounce = Math.min(255, Math.max(1, Math.ceil(opt.debounce / opt.interval)))
+        ADDON.keypadStart(this.keypadHandle, Math.round(opt.interval * 1000), debounce, (index, down, time) => {
+            const key = this.keypadKeys ? this.keypadKeys[index] : index
+            callback(key, down ? "down" : "up", time)
+        })
+    }
+
+    /** ------------------------------------------------------------------
+     * @method keypadStop
+     * @description Stop keypad scan
+     */
+    keypadStop() {
+        if (this.mode !== "keypad")
+            throw new Error("This line is not configured as keypad")
+
+        if (this.closed)
+            return
+
+        ADDON.keypadStop(this.keypadHandle)
     }
 
     // -------------------------------------------------------------------
@@ -320,11 +842,94 @@ export class RIO {
      * @description Static method to close all instances
      */
     static closeAll() {
-        for (const [line, instance] of RIO.instances) {
+        // Multi-line instances are listed once per line
+        for (const instance of new Set(RIO.instances.values())) {
             instance.close()
         }
     }
 
+    /** ------------------------------------------------------------------
+     * @function RIO.closeAllAsync
+     * @description Static method to close all instances in parallel without blocking the event loop
+     * @return {Promise} resolved when all lines are released
+     */
+    static closeAllAsync() {
+        const closing = []
+        // Multi-line instances are listed once per line
+        for (const instance of new Set(RIO.instances.values())) {
+            closing.push(instance.closeAsync())
+        }
+        return Promise.all(closing)
+    }
+
+
+    /** ------------------------------------------------------------------
+     * @function RIO.recordStart
+     * @description Record events of all monitored lines into a binary file
+     * @param {String} path
+     */
+    static recordStart(path) {
+        ADDON.recordStart(path)
+    }
+
+    /** ------------------------------------------------------------------
+     * @function RIO.recordStop
+     * @description Stop recording
+     * @return {Number} number of recorded events
+     */
+    static recordStop() {
+        return ADDON.recordStop()
+    }
+
+    /** ------------------------------------------------------------------
+     * @function RIO.replay
+     * @description Replay a recording through monitoringStart callbacks of the same lines
+     * @param {String} path
+     * @param {Object} opt - realtime: keep recorded timing, speed: time factor in realtime
+     * @return {Promise<Number>} number of delivered events
+     */
+    static replay(path, opt) {
+        opt = {realtime: true, speed: 1, ...opt}
+
+        if (typeof opt.speed !== "number" || opt.speed <= 0)
+            throw new Error("Replay speed is not valid")
+
+        return ADDON.replayStart(path, Boolean(opt.realtime), opt.speed)
+    }
+
+    /** ------------------------------------------------------------------
+     * @function RIO.replayStop
+     * @description Stop replay in progress
+     */
+    static replayStop() {
+        ADDON.replayStop()
+    }
+
+    /** ------------------------------------------------------------------
+     * @function RIO.pwmMoveAll
+     * @description Ramp several PWM lines in lock-step (same start, duration and profile)
+     * @param {Array} moves - [[instance, percent], ...]
+     * @param {Number} duration ms
+     * @param {Object} opt - profile: "linear", "trapezoidal", "s-curve", rate: updates per second
+     * @return {Promise<Boolean>} true when all targets are reached, false if cancelled
+     */
+    static pwmMoveAll(moves, duration, opt) {
+        opt = {profile: "linear", rate: 50, ...opt}
+
+        if (typeof duration !== "number" || duration < 0)
+            throw new Error("Motion duration is not valid")
+
+        if (opt.rate < 1 || opt.rate > 1000)
+            throw new Error("Motion rate is out of range (1 - 1000 Hz)")
+
+        const handles = [], duties = []
+        for (const [instance, percent] of moves) {
+            duties.push(instance.pwmDutyNs(percent))
+            handles.push(instance.pwmHandle)
+        }
+
+        return ADDON.pwmMove(handles, duties, Math.round(duration), opt.profile, Math.round(opt.rate))
+    }
 
     /** ------------------------------------------------------------------
      * @function RIO.model
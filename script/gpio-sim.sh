@@ -0,0 +1,57 @@
+#!/bin/bash
+# -------------------------------------------------------------------
+# RPI-IO: Setup/teardown of a simulated GPIO chip (kernel gpio-sim)
+# Requires root, configfs and kernel module gpio-sim (Linux >= 5.17)
+# Usage: gpio-sim.sh setup [num_lines]  --> prints "chip_name dev_name"
+#        gpio-sim.sh teardown
+# -------------------------------------------------------------------
+CONFIGFS="/sys/kernel/config"
+SIM_NAME="rpi-io-sim"
+SIM_PATH="$CONFIGFS/gpio-sim/$SIM_NAME"
+BANK_PATH="$SIM_PATH/gpio-bank0"
+
+fail() {
+    echo "Error: $1" >&2
+    exit 1
+}
+
+setup() {
+    local num_lines=${1:-8}
+
+    [ "$(id -u)" -eq 0 ] || fail "gpio-sim setup must be run as root"
+
+    modprobe gpio-sim 2>/dev/null
+    mountpoint -q "$CONFIGFS" || mount -t configfs none "$CONFIGFS" 2>/dev/null
+    [ -d "$CONFIGFS/gpio-sim" ] || fail "gpio-sim is not available (kernel module or configfs missing)"
+
+    # Start from a clean state if a previous run was interrupted
+    [ -d "$SIM_PATH" ] && teardown
+
+    mkdir "$SIM_PATH" || fail "cannot create $SIM_PATH"
+    mkdir "$BANK_PATH" || fail "cannot create $BANK_PATH"
+    echo "$num_lines" > "$BANK_PATH/num_lines"
+    echo 1 > "$SIM_PATH/live" || fail "cannot enable simulated chip"
+
+    # Chip and platform device names, e.g. "gpiochip4 gpio-sim.0"
+    echo "$(cat "$BANK_PATH/chip_name") $(cat "$SIM_PATH/dev_name")"
+}
+
+teardown() {
+    [ -d "$SIM_PATH" ] || return 0
+    echo 0 > "$SIM_PATH/live" 2>/dev/null
+    rmdir "$BANK_PATH" 2>/dev/null
+    rmdir "$SIM_PATH" || fail "cannot remove $SIM_PATH"
+}
+
+case "$1" in
+    setup)
+        setup "$2"
+        ;;
+    teardown)
+        teardown
+        ;;
+    *)
+        echo "Usage: $0 setup [num_lines] | teardown" >&2
+        exit 1
+        ;;
+esac
@@ -19,6 +19,13 @@ import {RIO, traceCfg, log, sleep, ctrlC, lineNumber} from "../esm/main.mjs"
 
     await sleep(1000)
     RIO.closeAll()
+    log("lines closed:", led.closed, btn.closed)
+
+    // Same lines again, closed in parallel without blocking the event loop
+    new RIO(line1, "output", {value: 0})
+    new RIO(line2, "input")
+    await RIO.closeAllAsync()
+    log("lines closed asynchronously")
 })()
 
 
@@ -0,0 +1,36 @@
+// -------------------------------------------------------------------
+// TEST - Keypad 4x4 scanned by a native thread
+// Usage: node test/keypad.js <row 1> .. <row 4> <col 1> .. <col 4>
+// -------------------------------------------------------------------
+import {RIO, traceCfg, log, sleep, ctrlC, lineNumber} from "../esm/main.mjs"
+
+(async () => {
+    traceCfg(2)
+    const lines = [2, 3, 4, 5, 6, 7, 8, 9].map(nth => lineNumber(nth))
+    if (lines.some(line => line < 0)) return
+
+    const keypad = new RIO(lines, "keypad", {keys: "123A456B789C*0#D"})
+    ctrlC(() => RIO.closeAllAsync())
+
+    let code = ""
+    log("type keys for 30s, # to show the code")
+    keypad.keypadStart((key, event, time) => {
+        log("key", key, event, "at", time, "ns")
+        if (event !== "down")
+            return
+
+        if (key === "#") {
+            log("code:", code)
+            code = ""
+        } else {
+            code += key
+        }
+    })
+
+    await sleep(30000)
+    await RIO.closeAllAsync()
+})()
+
+// -------------------------------------------------------------------
+// EoF
+// -------------------------------------------------------------------
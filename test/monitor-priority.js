@@ -0,0 +1,36 @@
+// -------------------------------------------------------------------
+// TEST - Event delivery by priority with rate caps
+// Usage: node test/monitor-priority.js <critical line> <noisy line> [<noisy line> ...]
+// -------------------------------------------------------------------
+import {RIO, traceCfg, log, sleep, ctrlC, lineNumber} from "../esm/main.mjs"
+
+(async () => {
+    traceCfg(2)
+    const lines = process.argv.slice(2).map((arg, i) => lineNumber(i + 2))
+    if (lines.length < 2 || lines.some(line => line < 0)) return
+
+    const [critical, ...noisy] = lines.map(line => new RIO(line, "input"))
+    ctrlC(() => RIO.closeAllAsync())
+
+    // Delay between kernel timestamp and callback, whatever the load of noisy lines
+    critical.monitoringStart((edge, time) => {
+        const delay = Number(process.hrtime.bigint() - time) / 1000
+        log("critical", edge, "delivered", delay.toFixed(0), "µs after the edge")
+    }, "both", 0, {priority: "high"})
+
+    // Noisy lines: low priority, 200 events/s max each, first one served twice as often
+    noisy.forEach((input, i) => {
+        input.monitoringStart(() => {}, "both", 0, {priority: "low", weight: i === 0 ? 2 : 1, rate: 200})
+    })
+
+    for (let s = 0; s < 10; s++) {
+        await sleep(1000, false)
+        noisy.forEach(input => log("line", input.line, input.monitoringStats()))
+    }
+
+    await RIO.closeAllAsync()
+})()
+
+// -------------------------------------------------------------------
+// EoF
+// -------------------------------------------------------------------
@@ -0,0 +1,53 @@
+// -------------------------------------------------------------------
+// TEST - Native motion profiles for servo-motors SG90
+// Usage: node test/pwm-motion.js <pwm line> [<pwm line 2>]
+// -------------------------------------------------------------------
+import {RIO, traceCfg, log, sleep, ctrlC, lineNumber} from "../esm/main.mjs"
+
+(async () => {
+    traceCfg(2)
+    const line = lineNumber(2)
+    if (line < 0) return
+
+    const servoOpt = {
+        exportTime: -1, // delay for export on init
+        period: 20000,  // 20,000,000 ns ~ 50 Hz
+        dutyMin: 500,   //    500,000 ns ~ 0.5 ms
+        dutyMax: 2500   //  2,500,000 ns ~ 2.5 ms
+    }
+    const servo = new RIO(line, "pwm", servoOpt)
+    ctrlC(() => RIO.closeAllAsync())
+
+    // Same move with each profile
+    for (const profile of ["linear", "trapezoidal", "s-curve"]) {
+        log("servo 0% -> 100% in 2s,", profile)
+        await servo.pwmMove(100, 2000, {profile})
+        await servo.pwmMove(0, 1000, {profile})
+    }
+
+    // Retarget: first move is cancelled and resolved to false
+    const first = servo.pwmMove(100, 2000)
+    await sleep(500)
+    log("retarget to 50% after 500 ms")
+    await servo.pwmMove(50, 500)
+    log("first move completed:", await first)
+
+    // Coordinated move of 2 servos (optional second line)
+    if (process.argv[3]) {
+        const line2 = lineNumber(3)
+        if (line2 >= 0) {
+            const servo2 = new RIO(line2, "pwm", servoOpt)
+            log("lock-step move of 2 servos")
+            await RIO.pwmMoveAll([[servo, 100], [servo2, 0]], 2000, {profile: "s-curve"})
+            await RIO.pwmMoveAll([[servo, 0], [servo2, 100]], 2000, {profile: "s-curve"})
+        }
+    }
+
+    await RIO.closeAllAsync()
+    log("servo closed")
+})()
+
+
+// -------------------------------------------------------------------
+// EoF
+// -------------------------------------------------------------------
@@ -0,0 +1,38 @@
+// -------------------------------------------------------------------
+// TEST - Ultrasonic sensor HC-SR04 (trigger output, echo input)
+// Usage: node test/ranging.js <trigger line> <echo line>
+// -------------------------------------------------------------------
+import {RIO, traceCfg, log, sleep, ctrlC, lineNumber} from "../esm/main.mjs"
+
+(async () => {
+    traceCfg(2)
+    // Sound speed 343 m/s, round trip => 1 cm ~ 58,309 ns
+    const cm = width => width < 0 ? "no echo" : (width / 58309).toFixed(1) + " cm"
+
+    const line1 = lineNumber(2)
+    if (line1 < 0) return
+
+    const line2 = lineNumber(3)
+    if (line2 < 0) return
+
+    const trigger = new RIO(line1, "output", {value: 0})
+    const echo = new RIO(line2, "input", {bias: "pull-down"})
+    ctrlC(() => RIO.closeAllAsync())
+
+    // Single measurements
+    log("distance (sync):", cm(echo.pulseMeasure(trigger, {pulse: 10, timeout: 60})))
+    log("distance (async):", cm(await echo.pulseMeasureAsync(trigger)))
+
+    // Continuous ranging for 5s
+    log("continuous ranging for 5s")
+    echo.rangingStart(trigger, width => {
+        log("distance:", cm(width))
+    }, {interval: 100})
+    await sleep(5000)
+    echo.rangingStop()
+    await RIO.closeAllAsync()
+})()
+
+// -------------------------------------------------------------------
+// EoF
+// -------------------------------------------------------------------
@@ -0,0 +1,43 @@
+// -------------------------------------------------------------------
+// TEST - Record events of an input line then replay them without hardware
+// Usage: node test/record-replay.js <input line>
+// -------------------------------------------------------------------
+import {RIO, traceCfg, log, sleep, ctrlC, lineNumber} from "../esm/main.mjs"
+
+(async () => {
+    traceCfg(2)
+    const path = "/tmp/rpi-io-events.rec"
+
+    const line1 = lineNumber(2)
+    if (line1 < 0) return
+
+    ctrlC(() => {
+        RIO.recordStop()
+        RIO.replayStop()
+        return RIO.closeAllAsync()
+    })
+
+    // Record events of the physical line for 10s
+    let gpio = new RIO(line1, "input", {bias: "pull-down"})
+    gpio.monitoringStart((edge, time) => {
+        log("recorded", edge, "at", time, "ns")
+    })
+    RIO.recordStart(path)
+    log("recording line", line1, "for 10s in", path)
+    await sleep(10000)
+    log("recorded events:", RIO.recordStop())
+    gpio.close()
+
+    // Replay through a virtual line: same callback path, recorded timestamps
+    gpio = new RIO(line1, "input", {replay: true})
+    gpio.monitoringStart((edge, time) => {
+        log("replayed", edge, "at", time, "ns - line value:", gpio.read())
+    })
+    log("real time replay (x2):", await RIO.replay(path, {speed: 2}), "events")
+    log("fast replay:", await RIO.replay(path, {realtime: false}), "events")
+    await RIO.closeAllAsync()
+})()
+
+// -------------------------------------------------------------------
+// EoF
+// -------------------------------------------------------------------
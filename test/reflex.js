@@ -0,0 +1,43 @@
+// -------------------------------------------------------------------
+// TEST - Native reflex rules: output driven by input edges
+// Usage: node test/reflex.js <input line> <output line>
+// -------------------------------------------------------------------
+import {RIO, traceCfg, log, sleep, ctrlC, lineNumber} from "../esm/main.mjs"
+
+(async () => {
+    traceCfg(2)
+    const inLine = lineNumber(2)
+    const outLine = lineNumber(3)
+    if (inLine < 0 || outLine < 0) return
+
+    const input = new RIO(inLine, "input")
+    const output = new RIO(outLine, "output", {value: 1})
+    ctrlC(() => RIO.closeAllAsync())
+
+    // Reaction time measured from the kernel timestamp of the edge
+    const notify = (edge, time, actionTime) => {
+        log(edge, "edge: output written", Number(actionTime - time) / 1000, "µs after the edge")
+    }
+
+    log("10s: output set to 0 on each rising edge, to 1 on each falling edge")
+    const down = input.reflexAdd(output, {edge: "rising", value: 0}, notify)
+    const up = input.reflexAdd(output, {edge: "falling", value: 1}, notify)
+    await sleep(10000)
+    input.reflexRemove(down)
+    input.reflexRemove(up)
+
+    log("10s: latched rule, output set to 0 after 500 ms on the first edge only")
+    output.write(1)
+    const once = input.reflexAdd(output, {edge: "both", value: 0, latch: true, delay: 500}, notify)
+    await sleep(5000)
+    log("rule re-armed")
+    output.write(1)
+    input.reflexReset(once)
+    await sleep(5000)
+
+    await RIO.closeAllAsync()
+})()
+
+// -------------------------------------------------------------------
+// EoF
+// -------------------------------------------------------------------
@@ -0,0 +1,59 @@
+// -------------------------------------------------------------------
+// TEST - Replay a recording of two lines whose events are out of order
+// Usage: node test/replay-order.js <line 1> <line 2> (virtual lines, no hardware)
+// -------------------------------------------------------------------
+import {writeFileSync} from "node:fs"
+import {RIO, traceCfg, log, warn, ctrlC, lineNumber} from "../esm/main.mjs"
+
+(async () => {
+    traceCfg(2)
+    const path = "/tmp/rpi-io-order.rec"
+
+    const line1 = lineNumber(2)
+    const line2 = lineNumber(3)
+    if (line1 < 0 || line2 < 0) return
+
+    ctrlC(() => {
+        RIO.replayStop()
+        return RIO.closeAllAsync()
+    })
+
+    // Monitor threads of several lines write their events concurrently:
+    // the first record is not the oldest one (ms, line, edge)
+    const events = [
+        [200, line1, 1],
+        [100, line2, 1],
+        [300, line1, 0],
+        [250, line2, 0],
+        [400, line1, 1]
+    ]
+    const buffer = Buffer.alloc(16 + events.length * 16)
+    buffer.write("RIOREC", 0, "latin1")
+    buffer.writeUInt16LE(1, 6)
+    buffer.writeBigUInt64LE(BigInt(events.length), 8)
+    events.forEach(([ms, line, edge], i) => {
+        buffer.writeBigUInt64LE(BigInt(ms) * 1000000n, 16 + i * 16)
+        buffer.writeUInt32LE(line, 24 + i * 16)
+        buffer.writeUInt8(edge, 28 + i * 16)
+    })
+    writeFileSync(path, buffer)
+
+    const gpio1 = new RIO(line1, "input", {replay: true})
+    const gpio2 = new RIO(line2, "input", {replay: true})
+    gpio1.monitoringStart((edge, time) => log("line", line1, "edge", edge, "at", Number(time) / 1e6, "ms"))
+    gpio2.monitoringStart((edge, time) => log("line", line2, "edge", edge, "at", Number(time) / 1e6, "ms"))
+
+    // Expected: 5 events in about 300ms (oldest record at 100ms, newest at 400ms)
+    const start = Date.now()
+    const delivered = await RIO.replay(path)
+    const elapsed = Date.now() - start
+    log("replayed:", delivered, "events in", elapsed, "ms")
+    if (delivered !== events.length || elapsed > 1000)
+        warn("unexpected replay: out of order records must not delay the replay")
+
+    await RIO.closeAllAsync()
+})()
+
+// -------------------------------------------------------------------
+// EoF
+// -------------------------------------------------------------------
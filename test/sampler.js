@@ -0,0 +1,41 @@
+// -------------------------------------------------------------------
+// TEST - Fixed-rate sampler of noisy inputs (contacts, slow signals)
+// Usage: node test/sampler.js <line> [<line> ...]
+// -------------------------------------------------------------------
+import {RIO, traceCfg, log, sleep, ctrlC, lineNumber} from "../esm/main.mjs"
+
+(async () => {
+    traceCfg(2)
+    const lines = process.argv.slice(2).map((arg, i) => lineNumber(i + 2))
+    if (!lines.length || lines.some(line => line < 0)) return
+
+    const inputs = new RIO(lines, "sampler", {bias: "pull-up"})
+    ctrlC(() => RIO.closeAllAsync())
+
+    log("10s: stable changes at 2 kHz, filter 20 samples (10 ms)")
+    inputs.samplerStart((line, value, time) => {
+        log("line", line, "is now", value, "at", time, "ns")
+    }, {rate: 2000, filter: 20})
+    log("initial values:", inputs.samplerValues())
+    await sleep(10000)
+    inputs.samplerStop()
+
+    log("5s: raw samples at 20 kHz")
+    inputs.samplerStart(null, {rate: 20000, buffer: 200000})
+    await sleep(5000)
+    inputs.samplerStop()
+    const {values, times, dropped, missed} = inputs.samplerRead()
+    log(values.length, "samples,", dropped, "dropped,", missed, "missed")
+    lines.forEach((line, i) => {
+        const highs = values.filter(v => (v >>> i) & 1).length
+        log("line", line, "high", (100 * highs / Math.max(1, values.length)).toFixed(1), "% of the time")
+    })
+    if (values.length > 1)
+        log("effective rate:", ((values.length - 1) * 1e9 / Number(times[values.length - 1] - times[0])).toFixed(0), "Hz")
+
+    await RIO.closeAllAsync()
+})()
+
+// -------------------------------------------------------------------
+// EoF
+// -------------------------------------------------------------------
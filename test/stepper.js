@@ -0,0 +1,41 @@
+// -------------------------------------------------------------------
+// TEST - Stepper motor driver (A4988, DRV8825...) with STEP/DIR/ENABLE
+// Usage: node test/stepper.js <step line> <dir line> [<enable line>]
+// -------------------------------------------------------------------
+import {RIO, traceCfg, log, sleep, ctrlC, lineNumber} from "../esm/main.mjs"
+
+(async () => {
+    traceCfg(2)
+    const lines = [lineNumber(2), lineNumber(3)]
+    if (lines.some(line => line < 0)) return
+
+    if (process.argv[4]) {
+        const enable = lineNumber(4)
+        if (enable < 0) return
+        lines.push(enable)
+    }
+
+    // 200 steps/revolution in full step mode
+    const motor = new RIO(lines, "stepper", {enableLevel: 0})
+    ctrlC(() => RIO.closeAllAsync())
+
+    log("1 revolution at 400 steps/s, no ramp")
+    await motor.stepperMove(200, 400)
+    log("position:", motor.stepperPosition())
+
+    log("5 revolutions back at 1000 steps/s, acceleration 2000 steps/s²")
+    await motor.stepperMove(-1000, 1000, 2000)
+    log("position:", motor.stepperPosition())
+
+    log("long move stopped after 2s with deceleration")
+    const move = motor.stepperMove(100000, 1000, 2000)
+    await sleep(2000)
+    motor.stepperStop()
+    log("move completed:", await move, "- position:", motor.stepperPosition())
+
+    await RIO.closeAllAsync()
+})()
+
+// -------------------------------------------------------------------
+// EoF
+// -------------------------------------------------------------------
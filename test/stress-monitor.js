@@ -0,0 +1,210 @@
+// -------------------------------------------------------------------
+// TEST - Stress & soak of event monitoring with kernel gpio-sim
+// No hardware required, root required (configfs).
+// Usage: node test/stress-monitor.js [lines] [rate (Hz/line)] [duration (s)]
+//        [max drop (%)] [max rss growth (MiB)] [max p99 latency (µs)]
+// Exit code 1 when a limit is exceeded or an event is delivered after close.
+// -------------------------------------------------------------------
+import {createRequire} from "node:module"
+import {execSync} from "node:child_process"
+import {openSync, writeSync, closeSync} from "node:fs"
+import {Worker, isMainThread, workerData} from "node:worker_threads"
+import {traceCfg, log, warn} from "../esm/log.mjs"
+import {sleep} from "../esm/ctl.mjs"
+
+const SIM_SCRIPT = new URL("../script/gpio-sim.sh", import.meta.url).pathname
+const RUN = 0, PAUSE = 1, STOP = 2
+const LATENCY_MAX = 100000 // µs, histogram resolution 1 µs
+const WARMUP = 2 // s, RSS reference sample
+// Default limits, overridden by arguments
+const DROP_LIMIT = 0.1 // %
+const RSS_GROWTH_LIMIT = 16 // MiB between warm-up and end of run
+const P99_LIMIT = 5000 // µs
+
+/** ------------------------------------------------------------------
+ * @function generator
+ * @description Worker: toggle pull of simulated lines at a fixed rate
+ */
+const generator = () => {
+    const {dev, chip, lines, rate, control, counters} = workerData
+    const state = new Int32Array(control)
+    const generated = new Float64Array(counters)
+    const fds = []
+    for (let i = 0; i < lines; i++)
+        fds.push(openSync("/sys/devices/platform/" + dev + "/" + chip + "/sim_gpio" + i + "/pull", "w"))
+
+    const period = 1000000000n / BigInt(rate)
+    let level = 0
+    let next = process.hrtime.bigint()
+    while (Atomics.load(state, 0) !== STOP) {
+        if (Atomics.load(state, 0) === PAUSE) {
+            Atomics.wait(state, 0, PAUSE)
+            next = process.hrtime.bigint()
+            continue
+        }
+        level ^= 1
+        for (let i = 0; i < lines; i++) {
+            writeSync(fds[i], level ? "pull-up" : "pull-down", 0)
+            generated[i]++
+        }
+        next += period
+        const delay = next - process.hrtime.bigint()
+        if (delay > 0n)
+            Atomics.wait(state, 0, RUN, Number(delay) / 1000000)
+    }
+    fds.forEach(fd => closeSync(fd))
+}
+
+/** ------------------------------------------------------------------
+ * @function percentile
+ * @description Return percentile (µs) from latency histogram
+ */
+const percentile = (histogram, total, p) => {
+    const target = total * p
+    let sum = 0
+    for (let i = 0; i < histogram.length; i++) {
+        sum += histogram[i]
+        if (sum >= target) return i
+    }
+    return LATENCY_MAX
+}
+
+/** ------------------------------------------------------------------
+ * @function stress
+ * @description Main thread: monitor simulated lines and report
+ */
+const stress = async () => {
+    traceCfg(2)
+    const require = createRequire(import.meta.url)
+    const ADDON = require("../build/Release/gpio.node")
+    const lines = parseInt(process.argv[2]) || 8
+    const rate = parseInt(process.argv[3]) || 1000
+    const duration = parseInt(process.argv[4]) || 10
+    const dropLimit = parseFloat(process.argv[5]) || DROP_LIMIT
+    const rssGrowthLimit = parseFloat(process.argv[6]) || RSS_GROWTH_LIMIT
+    const p99Limit = parseFloat(process.argv[7]) || P99_LIMIT
+
+    let chip, dev
+    try {
+        [chip, dev] = execSync("bash " + SIM_SCRIPT + " setup " + lines, {encoding: "utf8"}).trim().split(/\s+/)
+    } catch (err) {
+        warn("gpio-sim setup failed (root + gpio-sim module required)")
+        process.exitCode = 1
+        return
+    }
+    log("simulated chip", chip, "on", dev, "-", lines, "lines at", rate, "Hz for", duration, "s")
+
+    // Shared state with generator
+    const control = new SharedArrayBuffer(4)
+    const counters = new SharedArrayBuffer(8 * lines)
+    const state = new Int32Array(control)
+    const generated = new Float64Array(counters)
+
+    // Monitored lines
+    const delivered = new Float64Array(lines)
+    const sequence = new Float64Array(lines) // same edge twice in a row
+    const lastEdge = new Int8Array(lines).fill(-1)
+    const histogram = new Uint32Array(LATENCY_MAX + 1)
+    let latencyMax = 0
+    const closedAt = new Array(lines).fill(0n) // hrtime when closeAsync of the line resolved
+    let lateEvents = 0
+    const handles = []
+    for (let i = 0; i < lines; i++) {
+        const handle = ADDON.openInput("/dev/" + chip, i, "disable")
+        ADDON.startMonitoring(handle, (edge, time) => {
+            if (closedAt[i]) {
+                // The line is released: no event stamped afterwards may be delivered
+                if (time > closedAt[i]) lateEvents++
+                return
+            }
+            const latency = Number(process.hrtime.bigint() - time) / 1000
+            histogram[Math.min(LATENCY_MAX, Math.max(0, Math.round(latency)))]++
+            latencyMax = Math.max(latencyMax, latency)
+            edge === lastEdge[i] ? sequence[i]++ : false
+            lastEdge[i] = edge
+            delivered[i]++
+        })
+        handles.push(handle)
+    }
+
+    // RSS sampling
+    const rss = []
+    const sampler = setInterval(() => rss.push(process.memoryUsage.rss()), 1000)
+
+    // Soak
+    const worker = new Worker(new URL(import.meta.url), {workerData: {dev, chip, lines, rate, control, counters}})
+    const start = process.hrtime.bigint()
+    for (let s = 1; s <= duration; s++) {
+        await sleep(1000, false)
+        const sum = delivered.reduce((a, b) => a + b, 0)
+        log("t =", s + "s", "delivered:", sum, "rss:", (process.memoryUsage.rss() / 1048576).toFixed(1), "MiB")
+    }
+
+    // Pause storm and let queued events drain
+    Atomics.store(state, 0, PAUSE)
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e9
+    await sleep(500, false)
+    clearInterval(sampler)
+
+    const totalGenerated = generated.reduce((a, b) => a + b, 0)
+    const totalDelivered = delivered.reduce((a, b) => a + b, 0)
+    const totalSequence = sequence.reduce((a, b) => a + b, 0)
+    const dropped = totalGenerated - totalDelivered
+    const dropRate = 100 * dropped / Math.max(1, totalGenerated)
+    const p99 = percentile(histogram, totalDelivered, 0.99)
+    log("---------------------------------------------------------------")
+    log("generated:", totalGenerated, "(" + (totalGenerated / elapsed).toFixed(0), "edges/s)")
+    log("delivered:", totalDelivered, "(" + (totalDelivered / elapsed).toFixed(0), "events/s)")
+    log("dropped:", dropped, "(" + dropRate.toFixed(3) + "%)",
+        "- edge sequence errors:", totalSequence)
+    log("latency (µs) p50:", percentile(histogram, totalDelivered, 0.5),
+        "p99:", p99,
+        "p99.9:", percentile(histogram, totalDelivered, 0.999),
+        "max:", latencyMax.toFixed(0))
+    let rssGrowth = 0
+    if (rss.length > 1) {
+        const mib = v => (v / 1048576).toFixed(1)
+        const warm = rss[Math.min(WARMUP, rss.length - 1)]
+        rssGrowth = (rss[rss.length - 1] - warm) / 1048576
+        log("rss (MiB) first:", mib(rss[0]), "warm-up:", mib(warm), "max:", mib(Math.max(...rss)),
+            "last:", mib(rss[rss.length - 1]))
+    }
+
+    // Clean shutdown under load
+    Atomics.store(state, 0, RUN)
+    Atomics.notify(state, 0)
+    await sleep(500, false)
+    const closeStart = process.hrtime.bigint()
+    await Promise.all(handles.map((handle, i) => ADDON.closeAsync(handle).then(() => {
+        closedAt[i] = process.hrtime.bigint()
+    })))
+    const closeTime = Number(process.hrtime.bigint() - closeStart) / 1e6
+    await sleep(200, false)
+    log("close of", lines, "lines under load:", closeTime.toFixed(1), "ms - events stamped after close:", lateEvents)
+
+    Atomics.store(state, 0, STOP)
+    Atomics.notify(state, 0)
+    await new Promise(resolve => worker.on("exit", resolve))
+    execSync("bash " + SIM_SCRIPT + " teardown")
+
+    // Limits
+    const failures = []
+    if (dropRate > dropLimit)
+        failures.push("dropped " + dropRate.toFixed(3) + "% > " + dropLimit + "%")
+    if (rssGrowth > rssGrowthLimit)
+        failures.push("rss growth " + rssGrowth.toFixed(1) + " MiB > " + rssGrowthLimit + " MiB")
+    if (p99 > p99Limit)
+        failures.push("p99 latency " + p99 + " µs > " + p99Limit + " µs")
+    if (lateEvents > 0)
+        failures.push(lateEvents + " events stamped after close were delivered")
+
+    failures.forEach(failure => warn("limit exceeded:", failure))
+    if (failures.length)
+        process.exitCode = 1
+}
+
+isMainThread ? stress() : generator()
+
+// -------------------------------------------------------------------
+// EoF
+// -------------------------------------------------------------------